@@ -0,0 +1,121 @@
+#ifdef METAGEN_BENCH
+
+#include <time.h>
+#include "util.h"
+#include "arena.h"
+#include "string.h"
+#include "tokenizer.h"
+#include "bench.h"
+
+// Headers in the tree that look like what metagen gets fed, repeated until
+// the input is METAGEN_BENCH_INPUT_MB long.
+static const char* bench_inputs[] = {
+    "metagen/demo.h",
+    "metagen/arena_copy.h",
+    "metagen/output.h"
+};
+
+static u64 now_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (u64)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static String load_bench_input(Arena* arena) {
+    u64 size = (u64)METAGEN_BENCH_INPUT_MB << 20;
+    char* buffer = push_string(arena, size);
+    u64 used = 0;
+
+    while (used < size) {
+        u64 before = used;
+        for (u32 i = 0; i < ArrayCount(bench_inputs) && used < size; i++) {
+            FILE* file = fopen(bench_inputs[i], "rb");
+            if (file == NULL) {
+                continue;
+            }
+
+            used += fread(buffer+used, sizeof(char), size-used, file);
+            fclose(file);
+        }
+
+        if (used == before) {
+            return NULL_STRING;
+        }
+    }
+
+    return (String) { buffer, used };
+}
+
+// Stands in for the generated headers metagen runs over: long names, deep
+// indentation, few tokens per byte.
+static String generate_bench_input(Arena* arena) {
+    u64 size = (u64)METAGEN_BENCH_INPUT_MB << 20;
+    char* buffer = push_string(arena, size);
+    u64 used = 0;
+
+    for (u32 i = 0; ; i++) {
+        char record[256];
+        int len = snprintf(record, sizeof(record),
+                "typedef struct {\n"
+                "        GeneratedRecordStorage_%05u*    generated_record_%05u_storage;\n"
+                "        uint64_t                        generated_record_%05u_element_count;\n"
+                "} GeneratedRecordView_%05u;\n\n", i, i, i, i);
+
+        if (len < 0 || used + len > size) {
+            break;
+        }
+
+        memcpy(buffer+used, record, len);
+        used += len;
+    }
+
+    return (String) { buffer, used };
+}
+
+// Best of a few rounds over the whole input, so a stray page fault or
+// context switch doesn't count.
+static void bench_input(String name, String input) {
+    u64 best   = 0;
+    u64 tokens = 0;
+    for (u32 round = 0; round < METAGEN_BENCH_ROUNDS; round++) {
+        Tokenizer tokenizer = { input, 0 };
+        u64 start = now_ns();
+
+        tokens = 0;
+        while (get_next_token(&tokenizer).type != TOKEN_EOF) {
+            tokens++;
+        }
+
+        u64 elapsed = now_ns() - start;
+        if (best == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    f64 seconds = (f64)best / 1e9;
+    printf("[bench] metagen.tokenize.%.*s.%u %.2f MB/s\n", SP(name), METAGEN_BENCH_INPUT_MB, (f64)input.len / (1 << 20) / seconds);
+    printf("[bench] metagen.tokens.%.*s.%u %.2f Mtokens/s\n", SP(name), METAGEN_BENCH_INPUT_MB, (f64)tokens / 1e6 / seconds);
+}
+
+// Over the headers in the tree and over a generated one.
+void tokenizer_bench(void) {
+    if (!keyword_slots_check()) {
+        return;
+    }
+
+    Arena arena;
+    arena_init(&arena, ((u64)METAGEN_BENCH_INPUT_MB << 21) + KB(4));
+
+    String headers = load_bench_input(&arena);
+    if (headers.string == NULL) {
+        fprintf(stderr, "tokenizer_bench: run from the repository root\n");
+        return;
+    }
+
+    bench_input(strlit("headers"), headers);
+    bench_input(strlit("generated"), generate_bench_input(&arena));
+
+    arena_delete(&arena);
+}
+
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+// Host-side benchmarks, only built with `make meta_bench`. Results use the
+// same line format as the kernel's, see src/bench/bench.h:
+//
+//     [bench] <name>[.<size>] <value> <unit>
+
+#ifdef METAGEN_BENCH
+
+#define METAGEN_BENCH_INPUT_MB 16
+#define METAGEN_BENCH_ROUNDS   5
+
+void tokenizer_bench(void);
+
+#endif
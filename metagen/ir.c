@@ -0,0 +1,331 @@
+#include "util.h"
+#include "arena.h"
+#include "string.h"
+#include "tokenizer.h"
+#include "ir.h"
+
+static const char* builtin_type_names[] = {
+    [TOKEN_U8]   = "u8",
+    [TOKEN_U16]  = "u16",
+    [TOKEN_U32]  = "u32",
+    [TOKEN_U64]  = "u64",
+    [TOKEN_S8]   = "s8",
+    [TOKEN_S16]  = "s16",
+    [TOKEN_S32]  = "s32",
+    [TOKEN_S64]  = "s64",
+    [TOKEN_F32]  = "f32",
+    [TOKEN_F64]  = "f64",
+    [TOKEN_BOOL] = "bool"
+};
+
+// Line breaks are tokens for whoever wants them, declarations don't care.
+static Token next_token(Tokenizer* tokenizer) {
+    Token token;
+    do {
+        token = get_next_token(tokenizer);
+    } while (token.type == TOKEN_NEWLINE || token.type == TOKEN_CARRIAGE_RETURN);
+
+    return token;
+}
+
+static bool is_builtin_type(enum TokenType type) {
+    return type >= TOKEN_U8 && type <= TOKEN_BOOL;
+}
+
+// "long int", "short int", "long long" and "long double" all name one
+// type: `int` gives way to whatever it is paired with, `long` to anything
+// but `int` or another `long`.
+static void add_builtin_type(TypeNode* type, Token token) {
+    bool replace = type->base == TOKEN_UNKNOWN || str_cmp(type->base_name, strlit("int"));
+    if (str_cmp(type->base_name, strlit("long"))) {
+        replace = !str_cmp(token.string, strlit("long")) && !str_cmp(token.string, strlit("int"));
+    }
+
+    if (replace) {
+        type->base      = token.type;
+        type->base_name = token.string;
+    }
+}
+
+// Past a member this can't describe, a bitfield, a function pointer or a
+// nested struct or union, to whatever follows its semicolon. Stops on the
+// brace that closes the enclosing struct.
+static void skip_member(Tokenizer* tokenizer, Token* token) {
+    u32 depth = 0;
+    while (token->type != TOKEN_EOF) {
+        if (token->type == TOKEN_OPEN_PAREN || token->type == TOKEN_OPEN_SQUIGGLY_BRACE || token->type == TOKEN_OPEN_SQUARE_BRACE) {
+            depth++;
+        }
+        else if (token->type == TOKEN_CLOSE_SQUIGGLY_BRACE && depth == 0) {
+            return;
+        }
+        else if (token->type == TOKEN_CLOSE_PAREN || token->type == TOKEN_CLOSE_SQUIGGLY_BRACE || token->type == TOKEN_CLOSE_SQUARE_BRACE) {
+            depth -= depth > 0;
+        }
+        else if (token->type == TOKEN_SEMICOLON && depth == 0) {
+            *token = next_token(tokenizer);
+            return;
+        }
+
+        *token = next_token(tokenizer);
+    }
+}
+
+// The base type and qualifiers a declaration starts with, up to its first
+// declarator. TOKEN_UNKNOWN as the base if there is none.
+static TypeNode parse_specifiers(Tokenizer* tokenizer, Token* token) {
+    TypeNode type = {};
+    for (;; *token = next_token(tokenizer)) {
+        if (token->type == TOKEN_CONST_KEYWORD) {
+            type.qualifiers |= QUALIFIER_CONST;
+        }
+        else if (token->type == TOKEN_VOLATILE_KEYWORD) {
+            type.qualifiers |= QUALIFIER_VOLATILE;
+        }
+        else if (token->type == TOKEN_UNSIGNED_KEYWORD) {
+            type.qualifiers |= QUALIFIER_UNSIGNED;
+        }
+        else if (token->type == TOKEN_SIGNED_KEYWORD) {
+            type.qualifiers |= QUALIFIER_SIGNED;
+        }
+        else if (is_builtin_type(token->type)) {
+            add_builtin_type(&type, *token);
+        }
+        else if (type.base != TOKEN_UNKNOWN || (type.qualifiers & (QUALIFIER_UNSIGNED | QUALIFIER_SIGNED))) {
+            break;
+        }
+        else if (token->type == TOKEN_STRUCT_KEYWORD) {
+            *token = next_token(tokenizer);
+            if (token->type != TOKEN_IDENTIFIER) {
+                break;
+            }
+
+            type.base      = TOKEN_IDENTIFIER;
+            type.base_name = token->string;
+        }
+        else if (token->type == TOKEN_IDENTIFIER) {
+            type.base      = TOKEN_IDENTIFIER;
+            type.base_name = token->string;
+        }
+        else {
+            break;
+        }
+    }
+
+    // A lone `unsigned` or `signed` is an int.
+    if (type.base == TOKEN_UNKNOWN && (type.qualifiers & (QUALIFIER_UNSIGNED | QUALIFIER_SIGNED))) {
+        type.base      = TOKEN_S32;
+        type.base_name = strlit("int");
+    }
+
+    return type;
+}
+
+// One declaration, which may declare several members: `u16 first, *second;`.
+// Leaves `token` on whatever follows its semicolon.
+static void parse_members(Arena* arena, Tokenizer* tokenizer, Token* token, StructDecl* decl) {
+    TypeNode base = parse_specifiers(tokenizer, token);
+    if (base.base == TOKEN_UNKNOWN) {
+        skip_member(tokenizer, token);
+        return;
+    }
+
+    for (;;) {
+        MemberDecl* member = push_struct(arena, MemberDecl);
+        member->type = base;
+
+        for (;; *token = next_token(tokenizer)) {
+            if (token->type == TOKEN_ASTERIX) {
+                member->type.pointer_depth++;
+            }
+            else if (token->type == TOKEN_CONST_KEYWORD) {
+                member->type.qualifiers |= QUALIFIER_CONST;
+            }
+            else if (token->type == TOKEN_VOLATILE_KEYWORD) {
+                member->type.qualifiers |= QUALIFIER_VOLATILE;
+            }
+            else {
+                break;
+            }
+        }
+
+        if (token->type != TOKEN_IDENTIFIER) {
+            skip_member(tokenizer, token);
+            return;
+        }
+
+        member->name = token->string;
+        *token = next_token(tokenizer);
+
+        // Extents are kept as written, from the first token in the brackets
+        // to the end of the last.
+        while (token->type == TOKEN_OPEN_SQUARE_BRACE) {
+            *token = next_token(tokenizer);
+            Token first = *token;
+            Token last  = *token;
+            while (token->type != TOKEN_CLOSE_SQUARE_BRACE && token->type != TOKEN_SEMICOLON && token->type != TOKEN_EOF) {
+                last   = *token;
+                *token = next_token(tokenizer);
+            }
+
+            if (token->type != TOKEN_CLOSE_SQUARE_BRACE || member->type.array_count == TYPE_MAX_ARRAY_EXTENTS) {
+                skip_member(tokenizer, token);
+                return;
+            }
+
+            String extent = {};
+            if (first.type != TOKEN_CLOSE_SQUARE_BRACE) {
+                extent = (String) { first.string.string, last.string.string + last.string.len - first.string.string };
+            }
+
+            member->type.array_extents[member->type.array_count++] = extent;
+            *token = next_token(tokenizer);
+        }
+
+        if (token->type != TOKEN_COMMA && token->type != TOKEN_SEMICOLON) {
+            skip_member(tokenizer, token);
+            return;
+        }
+
+        if (decl->last_member != NULL) {
+            decl->last_member->next = member;
+        }
+        else {
+            decl->members = member;
+        }
+        decl->last_member = member;
+        decl->member_count++;
+
+        bool last_declarator = token->type == TOKEN_SEMICOLON;
+        *token = next_token(tokenizer);
+        if (last_declarator) {
+            return;
+        }
+    }
+}
+
+// From just past `struct` to the semicolon that ends the declaration. NULL
+// for anything that is not a named definition: `struct Tag* pointer`, a
+// forward declaration, an anonymous struct.
+static StructDecl* parse_struct(Arena* arena, Tokenizer* tokenizer, Token* token, bool is_typedef) {
+    String tag = {};
+    if (token->type == TOKEN_IDENTIFIER) {
+        tag    = token->string;
+        *token = next_token(tokenizer);
+    }
+
+    if (token->type != TOKEN_OPEN_SQUIGGLY_BRACE) {
+        return NULL;
+    }
+
+    StructDecl* decl = push_struct(arena, StructDecl);
+    *token = next_token(tokenizer);
+    while (token->type != TOKEN_CLOSE_SQUIGGLY_BRACE && token->type != TOKEN_EOF) {
+        parse_members(arena, tokenizer, token, decl);
+    }
+
+    *token = next_token(tokenizer);
+    if (is_typedef && token->type == TOKEN_IDENTIFIER) {
+        decl->name = token->string;
+    }
+    else if (tag.len != 0) {
+        decl->name   = tag;
+        decl->tagged = true;
+    }
+
+    // Whatever else is up to the semicolon declares variables or more names.
+    while (token->type != TOKEN_SEMICOLON && token->type != TOKEN_EOF) {
+        *token = next_token(tokenizer);
+    }
+
+    return decl->name.len != 0 ? decl : NULL;
+}
+
+// Every struct definition in the tokenizer's buffer, in order.
+StructList parse_structs(Arena* arena, Tokenizer* tokenizer) {
+    StructList structs = {};
+    bool is_typedef = false;
+
+    Token token = next_token(tokenizer);
+    while (token.type != TOKEN_EOF) {
+        if (token.type == TOKEN_STRUCT_KEYWORD) {
+            token = next_token(tokenizer);
+            StructDecl* decl = parse_struct(arena, tokenizer, &token, is_typedef);
+            if (decl != NULL) {
+                if (structs.last != NULL) {
+                    structs.last->next = decl;
+                }
+                else {
+                    structs.first = decl;
+                }
+                structs.last = decl;
+                structs.count++;
+            }
+            continue;
+        }
+
+        if (token.type == TOKEN_TYPEDEF_KEYWORD) {
+            is_typedef = true;
+        }
+        else if (token.type == TOKEN_SEMICOLON) {
+            is_typedef = false;
+        }
+
+        token = next_token(tokenizer);
+    }
+
+    return structs;
+}
+
+// Built-in types spelled with C's own keywords are named by what they are,
+// so `char` and `unsigned char` are both u8 and `long` is s64. Type names,
+// uint64_t included, keep their spelling.
+static bool spelled_with_c_keywords(TypeNode* type) {
+    static const String c_type_keywords[] = {
+        strlit("char"), strlit("short"), strlit("int"), strlit("long"), strlit("float"), strlit("double")
+    };
+
+    if (type->qualifiers & (QUALIFIER_UNSIGNED | QUALIFIER_SIGNED)) {
+        return true;
+    }
+
+    for (u32 i = 0; i < ArrayCount(c_type_keywords); i++) {
+        if (str_cmp(type->base_name, c_type_keywords[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The MetaType enumerator for a type: the base type's name, then _ptr for
+// each level of indirection and _array for each dimension. Qualifiers
+// don't change it.
+String meta_type_name(Arena* arena, TypeNode* type) {
+    String base_name = type->base_name;
+    if (is_builtin_type(type->base) && spelled_with_c_keywords(type)) {
+        enum TokenType base = type->base;
+        if ((type->qualifiers & QUALIFIER_UNSIGNED) && base >= TOKEN_S8 && base <= TOKEN_S64) {
+            base -= TOKEN_S8 - TOKEN_U8;
+        }
+        else if ((type->qualifiers & QUALIFIER_SIGNED) && base >= TOKEN_U8 && base <= TOKEN_U64) {
+            base += TOKEN_S8 - TOKEN_U8;
+        }
+
+        base_name = (String) { (char*)builtin_type_names[base], strlen(builtin_type_names[base]) };
+    }
+
+    StringBuilder builder = {};
+    str_builder_init(arena, &builder, sizeof("META_TYPE_") + base_name.len + type->pointer_depth*4 + type->array_count*6);
+
+    str_builder_append(&builder, strlit("META_TYPE_"));
+    str_builder_append(&builder, base_name);
+    for (u32 i = 0; i < type->pointer_depth; i++) {
+        str_builder_append(&builder, strlit("_ptr"));
+    }
+    for (u32 i = 0; i < type->array_count; i++) {
+        str_builder_append(&builder, strlit("_array"));
+    }
+
+    return str_builder_to_string(builder);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// What parse_structs() knows about each struct it reads, so codegen never
+// has to look at a type as a string again.
+//
+//     StructDecl -> MemberDecl -> TypeNode
+//
+// Every String points into the tokenizer's buffer, nothing is copied.
+
+#define TYPE_MAX_ARRAY_EXTENTS 4
+
+typedef enum {
+    QUALIFIER_CONST    = 1 << 0,
+    QUALIFIER_VOLATILE = 1 << 1,
+    QUALIFIER_UNSIGNED = 1 << 2,
+    QUALIFIER_SIGNED   = 1 << 3
+} TypeQualifier;
+
+typedef struct {
+    enum TokenType base;          // TOKEN_U8 ... TOKEN_BOOL, or TOKEN_IDENTIFIER for any other type name
+    String         base_name;     // As written, "uint64_t", "char", "Arena"
+    u8             qualifiers;    // TypeQualifier bits, wherever they appear in the declaration
+    u8             pointer_depth;
+    u8             array_count;
+    String         array_extents[TYPE_MAX_ARRAY_EXTENTS]; // As written, may be a macro
+} TypeNode;
+
+typedef struct MemberDecl {
+    TypeNode           type;
+    String             name;
+    struct MemberDecl* next;
+} MemberDecl;
+
+typedef struct StructDecl {
+    String             name;   // The typedef name, or the tag if there is none
+    bool               tagged; // Named by its tag, so it is `struct name` in C
+    MemberDecl*        members;
+    MemberDecl*        last_member;
+    u32                member_count;
+    struct StructDecl* next;
+} StructDecl;
+
+typedef struct {
+    StructDecl* first;
+    StructDecl* last;
+    u32         count;
+} StructList;
+
+StructList parse_structs(Arena* arena, Tokenizer* tokenizer);
+String     meta_type_name(Arena* arena, TypeNode* type);
@@ -162,16 +162,126 @@ char* str_builder_to_cstring(Arena* arena, StringBuilder builder) {
     return stringCopy;
 }
 
+// FNV-1a.
+u64 str_hash(String string) {
+    u64 hash = 0xCBF29CE484222325ull;
+    for (u64 i = 0; i < string.len; i++) {
+        hash = (hash ^ (u8)string.string[i]) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+void str_set_init(Arena* arena, StringSet* set, u64 capacity) {
+    u64 slots = 8;
+    while (slots < capacity*2) {
+        slots *= 2;
+    }
+
+    *set = (StringSet) {
+        .arena    = arena,
+        .slots    = push_array(arena, StringSetSlot, slots),
+        .capacity = slots,
+        .count    = 0
+    };
+}
+
+// The slot holding `string`, or the empty one it would go in.
+static StringSetSlot* str_set_find(StringSet* set, String string, u64 hash) {
+    u64 mask = set->capacity-1;
+    for (u64 i = hash & mask; ; i = (i+1) & mask) {
+        StringSetSlot* slot = &set->slots[i];
+        if (slot->string.string == NULL || (slot->hash == hash && str_cmp(slot->string, string))) {
+            return slot;
+        }
+    }
+}
+
+// The old slots stay behind in the arena.
+static void str_set_grow(StringSet* set) {
+    StringSet grown = {};
+    str_set_init(set->arena, &grown, set->capacity);
+
+    for (u64 i = 0; i < set->capacity; i++) {
+        StringSetSlot* slot = &set->slots[i];
+        if (slot->string.string != NULL) {
+            *str_set_find(&grown, slot->string, slot->hash) = *slot;
+        }
+    }
+
+    grown.count = set->count;
+    *set = grown;
+}
+
+// False if the string was already in the set.
+bool str_set_insert(StringSet* set, String string) {
+    u64 hash = str_hash(string);
+    StringSetSlot* slot = str_set_find(set, string, hash);
+    if (slot->string.string != NULL) {
+        return false;
+    }
+
+    *slot = (StringSetSlot) { hash, string };
+    set->count++;
+
+    if (set->count*2 > set->capacity) {
+        str_set_grow(set);
+    }
+
+    return true;
+}
+
+bool str_set_contains(StringSet* set, String string) {
+    return str_set_find(set, string, str_hash(string))->string.string != NULL;
+}
+
 void str_list_append(Arena* arena, StringList* array, String string) {
-    StringNode** node = &array->node;
-    while (*node != NULL) {
-        node = &(*node)->child;
+    // A list put together by hand may not know its last node yet.
+    if (array->last == NULL && array->node != NULL) {
+        array->last = array->node;
+        while (array->last->child != NULL) {
+            array->last = array->last->child;
+        }
     }
 
-    *node = push_struct(arena, StringNode);
-    (*node)->string = str_copy(arena, string);
-    (*node)->child = NULL;
+    StringNode* node = push_struct(arena, StringNode);
+    node->string = str_copy(arena, string);
+    node->child = NULL;
+
+    if (array->last != NULL) {
+        array->last->child = node;
+    }
+    else {
+        array->node = node;
+    }
+    array->last = node;
     array->count++;
+
+    if (array->set != NULL) {
+        str_set_insert(array->set, node->string);
+    }
+}
+
+// Appends only strings the list doesn't have yet. False if it had it.
+bool str_list_append_unique(Arena* arena, StringList* array, String string) {
+    if (str_list_string_exists(array, string)) {
+        return false;
+    }
+
+    str_list_append(arena, array, string);
+    return true;
+}
+
+// Gives the list a set of its strings, sized for `capacity` of them before
+// it first grows.
+void str_list_index(Arena* arena, StringList* array, u64 capacity) {
+    array->set = push_struct(arena, StringSet);
+    str_set_init(arena, array->set, capacity > array->count ? capacity : array->count);
+
+    StringNode* string_node;
+    STR_LIST_FOREACH(array, string_node) {
+        str_set_insert(array->set, string_node->string);
+    }
 }
 
 StringNode* str_list_get_last(StringList* array) {
@@ -179,6 +289,10 @@ StringNode* str_list_get_last(StringList* array) {
         return NULL;
     }
 
+    if (array->last != NULL) {
+        return array->last;
+    }
+
     StringNode* string_node;
     STR_LIST_FOREACH_VALID_CHILD(array, string_node);
     return string_node;
@@ -204,7 +318,32 @@ StringArray str_list_to_array(Arena* arena, StringList* array) {
     return string_array;
 }
 
+// Like str_list_to_array() but the Strings still point at the list's
+// memory, only the array itself is allocated.
+StringArray str_list_view(Arena* arena, StringList* array) {
+    if (array->count == 0) {
+        return (StringArray) { NULL, 0 };
+    }
+
+    StringArray string_array = {
+        .strings = push_array(arena, String, array->count),
+        .count = array->count
+    };
+
+    StringNode* string_node;
+    u64 i = 0;
+    STR_LIST_FOREACH(array, string_node) {
+        string_array.strings[i++] = string_node->string;
+    }
+
+    return string_array;
+}
+
 bool str_list_string_exists(StringList* array, String search_string) {
+    if (array->set != NULL) {
+        return str_set_contains(array->set, search_string);
+    }
+
     StringNode* string_node;
     STR_LIST_FOREACH(array, string_node) {
         if (str_cmp(string_node->string, search_string)) {
@@ -10,9 +10,27 @@ typedef struct StringNode {
     struct StringNode* child;
 } StringNode;
 
+// Open addressing over the hash of each string, linear probing. Grows in
+// its arena once it is half full. Holds the Strings, not copies of them.
+typedef struct {
+    u64    hash;
+    String string; // .string is NULL for an empty slot
+} StringSetSlot;
+
+typedef struct {
+    Arena*         arena;
+    StringSetSlot* slots;
+    u64            capacity; // A power of two
+    u64            count;
+} StringSet;
+
+// `last` makes appends O(1). A list given a set with str_list_index() also
+// answers str_list_string_exists() without walking it.
 typedef struct {
     StringNode* node;
+    StringNode* last;
     u64 count;
+    StringSet* set;
 } StringList;
 
 typedef struct {
@@ -48,7 +66,14 @@ bool        str_builder_remove(StringBuilder* builder, uint64_t removeLen);
 String      str_builder_to_string(StringBuilder builder); 
 String      str_builder_copy_string(Arena* arena, StringBuilder builder); 
 char*       str_builder_to_cstring(Arena* arena, StringBuilder builder); 
+u64         str_hash(String string);
+void        str_set_init(Arena* arena, StringSet* set, u64 capacity);
+bool        str_set_insert(StringSet* set, String string);
+bool        str_set_contains(StringSet* set, String string);
 void        str_list_append(Arena* arena, StringList* array, String string);
+bool        str_list_append_unique(Arena* arena, StringList* array, String string);
+void        str_list_index(Arena* arena, StringList* array, u64 capacity);
 StringNode* str_list_get_last(StringList* array);
 StringArray str_list_to_array(Arena* arena, StringList* array);
+StringArray str_list_view(Arena* arena, StringList* array);
 bool        str_list_string_exists(StringList* array, String searchString);
@@ -0,0 +1,294 @@
+#include "util.h"
+#include "arena.h"
+#include "string.h"
+#include "tokenizer.h"
+
+char* TokenTypeStrings[]  = {
+    "TOKEN_UNKNOWN",
+    "TOKEN_IDENTIFIER",
+    "TOKEN_EOF",
+    "TOKEN_SEMICOLON",
+    "TOKEN_COLON",
+    "TOKEN_COMMA",
+    "TOKEN_ASTERIX",
+    "TOKEN_U8",
+    "TOKEN_U16",
+    "TOKEN_U32",
+    "TOKEN_U64",
+    "TOKEN_S8",
+    "TOKEN_S16",
+    "TOKEN_S32",
+    "TOKEN_S64",
+    "TOKEN_F32",
+    "TOKEN_F64",
+    "TOKEN_BOOL",
+    "TOKEN_OPEN_SQUIGGLY_BRACE",
+    "TOKEN_CLOSE_SQUIGGLY_BRACE",
+    "TOKEN_OPEN_PAREN",
+    "TOKEN_CLOSE_PAREN",
+    "TOKEN_OPEN_SQUARE_BRACE",
+    "TOKEN_CLOSE_SQUARE_BRACE",
+    "TOKEN_STRUCT_KEYWORD",
+    "TOKEN_TYPEDEF_KEYWORD",
+    "TOKEN_UNSIGNED_KEYWORD",
+    "TOKEN_SIGNED_KEYWORD",
+    "TOKEN_CONST_KEYWORD",
+    "TOKEN_VOLATILE_KEYWORD",
+    "TOKEN_STRUCT_NAME",
+    "TOKEN_NEWLINE",
+    "TOKEN_CARRIAGE_RETURN",
+    "TOKEN_FUNCTION_NAME"
+};
+
+// TODO(ali): There are probably more whitespace characters that we need to handle.
+const u8 char_classes[256] = {
+    [' ']  = CHAR_WHITESPACE,
+    ['\t'] = CHAR_WHITESPACE,
+    ['\r'] = CHAR_NEWLINE,
+    ['\n'] = CHAR_NEWLINE,
+    [';']  = CHAR_PUNCTUATION,
+    [':']  = CHAR_PUNCTUATION,
+    [',']  = CHAR_PUNCTUATION,
+    ['{']  = CHAR_PUNCTUATION,
+    ['}']  = CHAR_PUNCTUATION,
+    ['[']  = CHAR_PUNCTUATION,
+    [']']  = CHAR_PUNCTUATION,
+    ['(']  = CHAR_PUNCTUATION,
+    [')']  = CHAR_PUNCTUATION,
+    ['*']  = CHAR_PUNCTUATION,
+    ['/']  = CHAR_SLASH
+};
+
+static u64 skip_whitespace(const char* buffer, u64 position, u64 len) {
+    while (position < len && char_class(buffer[position]) == CHAR_WHITESPACE) {
+        position++;
+    }
+
+    return position;
+}
+
+static u64 find_break(const char* buffer, u64 position, u64 len) {
+    while (position < len && !(char_class(buffer[position]) & CHAR_BREAK)) {
+        position++;
+    }
+
+    return position;
+}
+
+typedef struct {
+    String keyword;
+    enum TokenType type;
+} Keyword;
+
+// Every keyword sits at the index keyword_hash() gives it, worked out ahead
+// of time. The multipliers in keyword_hash() were searched for so that each
+// one gets a slot of its own. Adding a keyword means finding its slot, and
+// a new pair of multipliers if that one is taken; the bench checks them all.
+static const Keyword keyword_slots[KEYWORD_SLOTS] = {
+    [  3] = { strlit("f32"),      TOKEN_F32 },
+    [  5] = { strlit("bool"),     TOKEN_BOOL },
+    [  7] = { strlit("int"),      TOKEN_S32 },
+    [  9] = { strlit("uint8_t"),  TOKEN_U8 },
+    [ 10] = { strlit("char"),     TOKEN_U8 },
+    [ 11] = { strlit("s8"),       TOKEN_S8 },
+    [ 12] = { strlit("f64"),      TOKEN_F64 },
+    [ 13] = { strlit("u8"),       TOKEN_U8 },
+    [ 16] = { strlit("s32"),      TOKEN_S32 },
+    [ 18] = { strlit("u32"),      TOKEN_U32 },
+    [ 25] = { strlit("s64"),      TOKEN_S64 },
+    [ 26] = { strlit("s16"),      TOKEN_S16 },
+    [ 27] = { strlit("u64"),      TOKEN_U64 },
+    [ 28] = { strlit("u16"),      TOKEN_U16 },
+    [ 29] = { strlit("double"),   TOKEN_F64 },
+    [ 37] = { strlit("int8_t"),   TOKEN_S8 },
+    [ 53] = { strlit("signed"),   TOKEN_SIGNED_KEYWORD },
+    [ 57] = { strlit("const"),    TOKEN_CONST_KEYWORD },
+    [ 58] = { strlit("int16_t"),  TOKEN_S16 },
+    [ 60] = { strlit("int32_t"),  TOKEN_S32 },
+    [ 61] = { strlit("float"),    TOKEN_F32 },
+    [ 63] = { strlit("int64_t"),  TOKEN_S64 },
+    [ 74] = { strlit("short"),    TOKEN_S16 },
+    [ 79] = { strlit("typedef"),  TOKEN_TYPEDEF_KEYWORD },
+    [ 98] = { strlit("uint16_t"), TOKEN_U16 },
+    [100] = { strlit("uint32_t"), TOKEN_U32 },
+    [103] = { strlit("uint64_t"), TOKEN_U64 },
+    [104] = { strlit("unsigned"), TOKEN_UNSIGNED_KEYWORD },
+    [108] = { strlit("struct"),   TOKEN_STRUCT_KEYWORD },
+    [121] = { strlit("volatile"), TOKEN_VOLATILE_KEYWORD },
+    [127] = { strlit("long"),     TOKEN_S64 },
+};
+
+static u32 keyword_hash(String string) {
+    u8 first  = string.string[0];
+    u8 middle = string.string[string.len >> 1];
+    u8 last   = string.string[string.len-1];
+    return (first + last*3 + (u32)string.len*28 + middle) & (KEYWORD_SLOTS-1);
+}
+
+#ifdef METAGEN_BENCH
+bool keyword_slots_check(void) {
+    bool valid = true;
+    for (u32 slot = 0; slot < KEYWORD_SLOTS; slot++) {
+        String keyword = keyword_slots[slot].keyword;
+        if (keyword.len != 0 && keyword_hash(keyword) != slot) {
+            fprintf(stderr, "tokenizer: keyword %.*s is in slot %u, it hashes to %u\n", SP(keyword), slot, keyword_hash(keyword));
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+#endif
+
+enum TokenType keyword_lookup(String string) {
+    if (string.len == 0) {
+        return TOKEN_IDENTIFIER;
+    }
+
+    const Keyword* keyword = &keyword_slots[keyword_hash(string)];
+    if (str_cmp(string, keyword->keyword)) {
+        return keyword->type;
+    }
+
+    return TOKEN_IDENTIFIER;
+}
+
+static bool comment_starts(const char* buffer, u64 position, u64 len) {
+    return position+1 < len && buffer[position] == '/' && (buffer[position+1] == '/' || buffer[position+1] == '*');
+}
+
+// Up to the line break, which is still handed out as a token.
+static u64 skip_line_comment(const char* buffer, u64 position, u64 len) {
+    while (position < len && char_class(buffer[position]) != CHAR_NEWLINE) {
+        position++;
+    }
+
+    return position;
+}
+
+// Past the closing "*/", or to the end if there is none.
+static u64 skip_block_comment(const char* buffer, u64 position, u64 len) {
+    for (position += 2; position+1 < len; position++) {
+        if (buffer[position] == '*' && buffer[position+1] == '/') {
+            return position+2;
+        }
+    }
+
+    return len;
+}
+
+// A '#' only starts a directive as the first thing on its line.
+static bool directive_starts(const char* buffer, u64 position) {
+    if (buffer[position] != '#') {
+        return false;
+    }
+
+    while (position > 0 && char_class(buffer[position-1]) == CHAR_WHITESPACE) {
+        position--;
+    }
+
+    return position == 0 || char_class(buffer[position-1]) == CHAR_NEWLINE;
+}
+
+// Up to the line break that ends the directive, following backslash
+// continuations. A block comment inside may run over several lines.
+static u64 skip_directive(const char* buffer, u64 position, u64 len) {
+    while (position < len) {
+        char character = buffer[position];
+        if (char_class(character) == CHAR_NEWLINE) {
+            return position;
+        }
+
+        if (character == '\\' && position+1 < len && char_class(buffer[position+1]) == CHAR_NEWLINE) {
+            position += 2;
+            if (buffer[position-1] == '\r' && position < len && buffer[position] == '\n') {
+                position++;
+            }
+        }
+        else if (character == '/' && comment_starts(buffer, position, len)) {
+            position = buffer[position+1] == '*' ? skip_block_comment(buffer, position, len) : skip_line_comment(buffer, position, len);
+        }
+        else {
+            position++;
+        }
+    }
+
+    return len;
+}
+
+// Comments and preprocessor lines go the same way as whitespace, before a
+// token is ever formed.
+static u64 skip_ignored(const char* buffer, u64 position, u64 len) {
+    for (;;) {
+        position = skip_whitespace(buffer, position, len);
+        if (position >= len) {
+            return position;
+        }
+
+        if (comment_starts(buffer, position, len)) {
+            position = buffer[position+1] == '*' ? skip_block_comment(buffer, position, len) : skip_line_comment(buffer, position, len);
+        }
+        else if (directive_starts(buffer, position)) {
+            position = skip_directive(buffer, position, len);
+        }
+        else {
+            return position;
+        }
+    }
+}
+
+// A slash that doesn't start a comment is part of the token.
+static u64 find_token_end(const char* buffer, u64 position, u64 len) {
+    for (;;) {
+        position = find_break(buffer, position, len);
+        if (position >= len || buffer[position] != '/' || comment_starts(buffer, position, len)) {
+            return position;
+        }
+        position++;
+    }
+}
+
+Token get_next_token(Tokenizer* tokenizer) {
+    if (tokenizer->count >= tokenizer->buffer.len-1) {
+        return (Token) {
+            .string = NULL_STRING,
+                .type = TOKEN_EOF
+        };
+    }
+
+    char* buffer = tokenizer->buffer.string;
+    u64   len    = tokenizer->buffer.len;
+
+    u64 token_start_pos, token_end_pos;
+    tokenizer->count = skip_ignored(buffer, tokenizer->count, len);
+    if (tokenizer->count >= len) {
+        return (Token) { NULL_STRING, TOKEN_EOF };
+    }
+
+    // NOTE(ali): If last word contained a punctuation mark, token_end_pos stops there
+    //            so token_start_pos now will be at the punctuation now.
+    token_start_pos = tokenizer->count;
+    if (char_class(buffer[token_start_pos]) & (CHAR_PUNCTUATION | CHAR_NEWLINE)) {
+        tokenizer->count++;
+        switch (buffer[token_start_pos]) {
+            case ';':  return (Token) { strlit(";"),  TOKEN_SEMICOLON };
+            case ':':  return (Token) { strlit(":"),  TOKEN_COLON };
+            case ',':  return (Token) { strlit(","),  TOKEN_COMMA };
+            case '{':  return (Token) { strlit("{"),  TOKEN_OPEN_SQUIGGLY_BRACE };
+            case '}':  return (Token) { strlit("}"),  TOKEN_CLOSE_SQUIGGLY_BRACE };
+            case '[':  return (Token) { strlit("["),  TOKEN_OPEN_SQUARE_BRACE };
+            case ']':  return (Token) { strlit("]"),  TOKEN_CLOSE_SQUARE_BRACE };
+            case '(':  return (Token) { strlit("("),  TOKEN_OPEN_PAREN };
+            case ')':  return (Token) { strlit(")"),  TOKEN_CLOSE_PAREN };
+            case '*':  return (Token) { strlit("*"),  TOKEN_ASTERIX };
+            case '\r': return (Token) { strlit("\r"), TOKEN_CARRIAGE_RETURN };
+            case '\n': return (Token) { strlit("\n"), TOKEN_NEWLINE };
+        };
+    }
+
+    tokenizer->count = find_token_end(buffer, tokenizer->count, len);
+    token_end_pos = tokenizer->count;
+
+    String token_string = str_range(tokenizer->buffer, token_start_pos, token_end_pos);
+    return (Token) { token_string, keyword_lookup(token_string) };
+}
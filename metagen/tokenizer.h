@@ -0,0 +1,75 @@
+#pragma once
+
+enum TokenType {
+    TOKEN_UNKNOWN,
+    TOKEN_IDENTIFIER,
+    TOKEN_EOF,
+    TOKEN_SEMICOLON,
+    TOKEN_COLON,
+    TOKEN_COMMA,
+    TOKEN_ASTERIX,
+    TOKEN_U8,
+    TOKEN_U16,
+    TOKEN_U32,
+    TOKEN_U64,
+    TOKEN_S8,
+    TOKEN_S16,
+    TOKEN_S32,
+    TOKEN_S64,
+    TOKEN_F32,
+    TOKEN_F64,
+    TOKEN_BOOL,
+    TOKEN_OPEN_SQUIGGLY_BRACE,
+    TOKEN_CLOSE_SQUIGGLY_BRACE,
+    TOKEN_OPEN_PAREN,
+    TOKEN_CLOSE_PAREN,
+    TOKEN_OPEN_SQUARE_BRACE,
+    TOKEN_CLOSE_SQUARE_BRACE,
+    TOKEN_STRUCT_KEYWORD,
+    TOKEN_TYPEDEF_KEYWORD,
+    TOKEN_UNSIGNED_KEYWORD,
+    TOKEN_SIGNED_KEYWORD,
+    TOKEN_CONST_KEYWORD,
+    TOKEN_VOLATILE_KEYWORD,
+    TOKEN_STRUCT_NAME,
+    TOKEN_NEWLINE,
+    TOKEN_CARRIAGE_RETURN,
+    TOKEN_FUNCTION_NAME // TODO(ali): Maybe support parsing functions?
+};
+
+extern char* TokenTypeStrings[];
+
+typedef struct {
+    String buffer;
+    u64 count;
+} Tokenizer;
+
+typedef struct {
+    String string;
+    enum TokenType type;
+} Token;
+
+// Character classes, a token ends at any of them. A slash only ends one
+// if a comment starts there.
+#define CHAR_WHITESPACE  (1 << 0)
+#define CHAR_NEWLINE     (1 << 1)
+#define CHAR_PUNCTUATION (1 << 2)
+#define CHAR_SLASH       (1 << 3)
+#define CHAR_BREAK       (CHAR_WHITESPACE | CHAR_NEWLINE | CHAR_PUNCTUATION | CHAR_SLASH)
+
+extern const u8 char_classes[256];
+
+#define char_class(character) char_classes[(u8)(character)]
+
+// Keywords and built-in type names go through a perfect hash of the first,
+// middle and last character and the length, so classifying an identifier
+// costs one hash and at most one comparison. The table is a constant, the
+// bench checks it with keyword_slots_check().
+#define KEYWORD_SLOTS 128
+
+Token          get_next_token(Tokenizer* tokenizer);
+enum TokenType keyword_lookup(String string);
+
+#ifdef METAGEN_BENCH
+bool           keyword_slots_check(void);
+#endif
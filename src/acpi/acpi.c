@@ -0,0 +1,219 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "mem.h"
+#include "acpi.h"
+
+#define MADT_FLAG_PCAT_COMPAT (1 << 0)
+
+#define MADT_LOCAL_APIC       0
+#define MADT_IO_APIC          1
+#define MADT_SOURCE_OVERRIDE  2
+#define MADT_LOCAL_X2APIC     9
+
+typedef struct __attribute__((packed)) {
+    char signature[8];
+    u8   checksum;
+    char oem_id[6];
+    u8   revision;
+    u32  rsdt_address;
+    // ACPI 2.0 and later
+    u32  length;
+    u64  xsdt_address;
+    u8   extended_checksum;
+    u8   reserved[3];
+} AcpiRsdp;
+
+typedef struct __attribute__((packed)) {
+    AcpiHeader header;
+    u32        lapic_address;
+    u32        flags;
+} AcpiMadtHeader;
+
+typedef struct __attribute__((packed)) {
+    u8 type;
+    u8 length;
+} MadtEntry;
+
+typedef struct __attribute__((packed)) {
+    MadtEntry entry;
+    u8        id;
+    u8        reserved;
+    u32       address;
+    u32       gsi_base;
+} MadtIoApic;
+
+typedef struct __attribute__((packed)) {
+    MadtEntry entry;
+    u8        bus;
+    u8        source; // ISA IRQ
+    u32       gsi;
+    u16       flags;
+} MadtSourceOverride;
+
+static AcpiHeader* root;      // XSDT, or the RSDT on ACPI 1.0
+static bool        root_is_xsdt;
+static AcpiMadt    madt;
+static bool        madt_found;
+
+static bool checksum_ok(const void* data, u64 length) {
+    u8 sum = 0;
+    for (u64 i = 0; i < length; i++) {
+        sum += ((const u8*)data)[i];
+    }
+
+    return sum == 0;
+}
+
+// Returns the direct map address of [phys, phys+size), mapping the pages
+// that aren't there read-only first.
+void* acpi_map(u64 phys, u64 size) {
+    u64 first = phys & ~(u64)(PAGE_SIZE-1);
+    u64 last  = (phys + size - 1) & ~(u64)(PAGE_SIZE-1);
+
+    for (u64 page = first; page <= last; page += PAGE_SIZE) {
+        u64 virt = (u64)phys_to_virt(page);
+        if (vmm_translate(virt) == 0 && !vmm_map(virt, page, 1, 0, NULL)) {
+            return NULL;
+        }
+    }
+
+    return phys_to_virt(phys);
+}
+
+// Maps the header to learn the length, then the whole table.
+static AcpiHeader* map_table(u64 phys) {
+    AcpiHeader* header = acpi_map(phys, sizeof(AcpiHeader));
+    if (header == NULL || acpi_map(phys, header->length) == NULL) {
+        return NULL;
+    }
+
+    if (!checksum_ok(header, header->length)) {
+        print_log(strlit("acpi: bad checksum on a "));
+        print_log((String) { header->signature, 4 });
+        print_log(strlit(" table\n"));
+        return NULL;
+    }
+
+    return header;
+}
+
+AcpiHeader* acpi_find_table(const char* signature) {
+    if (root == NULL) {
+        return NULL;
+    }
+
+    u64 entry_size = root_is_xsdt ? 8 : 4;
+    u64 count      = (root->length - sizeof(AcpiHeader)) / entry_size;
+    u8* entries    = (u8*)root + sizeof(AcpiHeader);
+
+    for (u64 i = 0; i < count; i++) {
+        u64 phys = 0;
+        memcpy(&phys, entries + i*entry_size, entry_size); // Entries aren't aligned
+
+        AcpiHeader* header = acpi_map(phys, sizeof(AcpiHeader));
+        if (header != NULL && memcmp(header->signature, signature, 4) == 0) {
+            return map_table(phys);
+        }
+    }
+
+    return NULL;
+}
+
+static void parse_madt(AcpiMadtHeader* table) {
+    madt.has_8259 = (table->flags & MADT_FLAG_PCAT_COMPAT) != 0;
+    for (u32 irq = 0; irq < ACPI_ISA_IRQS; irq++) {
+        madt.isa_irqs[irq] = (AcpiIsaIrq) { .gsi = irq, .flags = 0 };
+    }
+
+    u8* end = (u8*)table + table->header.length;
+    for (u8* cursor = (u8*)(table + 1); cursor + sizeof(MadtEntry) <= end;) {
+        MadtEntry* entry = (MadtEntry*)cursor;
+        if (entry->length < sizeof(MadtEntry) || cursor + entry->length > end) {
+            break;
+        }
+
+        switch (entry->type) {
+            case MADT_LOCAL_APIC:
+            case MADT_LOCAL_X2APIC:
+                madt.lapic_count++;
+                break;
+            case MADT_IO_APIC: {
+                MadtIoApic* ioapic = (MadtIoApic*)entry;
+                if (madt.ioapic_count < ACPI_MAX_IOAPICS) {
+                    madt.ioapics[madt.ioapic_count++] = (AcpiIoApic) {
+                        .id       = ioapic->id,
+                        .address  = ioapic->address,
+                        .gsi_base = ioapic->gsi_base
+                    };
+                }
+                break;
+            }
+            case MADT_SOURCE_OVERRIDE: {
+                MadtSourceOverride* override = (MadtSourceOverride*)entry;
+                if (override->bus == 0 && override->source < ACPI_ISA_IRQS) {
+                    madt.isa_irqs[override->source] = (AcpiIsaIrq) {
+                        .gsi   = override->gsi,
+                        .flags = override->flags
+                    };
+                }
+                break;
+            }
+        }
+
+        cursor += entry->length;
+    }
+}
+
+// With base revision 3 Limine reports the RSDP by physical address, older
+// revisions gave a direct map pointer. Both are accepted.
+bool acpi_init(struct limine_rsdp_response* response) {
+    if (response == NULL || response->address == NULL) {
+        print_log(strlit("acpi: no RSDP\n"));
+        return false;
+    }
+
+    u64 address = (u64)response->address;
+    u64 phys    = address >= hhdm_offset ? address - hhdm_offset : address;
+
+    AcpiRsdp* rsdp = acpi_map(phys, sizeof(AcpiRsdp));
+    if (rsdp == NULL || memcmp(rsdp->signature, "RSD PTR ", 8) != 0 || !checksum_ok(rsdp, 20)) {
+        print_log(strlit("acpi: bad RSDP\n"));
+        return false;
+    }
+
+    if (rsdp->revision >= 2 && rsdp->xsdt_address != 0) {
+        root_is_xsdt = true;
+        root = map_table(rsdp->xsdt_address);
+    }
+    else {
+        root = map_table(rsdp->rsdt_address);
+    }
+
+    if (root == NULL) {
+        print_log(strlit("acpi: couldn't map the root table\n"));
+        return false;
+    }
+
+    AcpiMadtHeader* table = (AcpiMadtHeader*)acpi_find_table("APIC");
+    if (table != NULL) {
+        parse_madt(table);
+        madt_found = true;
+    }
+
+    print_log(strlit("acpi: revision "));
+    print_log_u64(rsdp->revision);
+    print_log(strlit(", "));
+    print_log_u64(madt.lapic_count);
+    print_log(strlit(" local APICs, "));
+    print_log_u64(madt.ioapic_count);
+    print_log(strlit(" I/O APICs\n"));
+    return true;
+}
+
+const AcpiMadt* acpi_madt(void) {
+    return madt_found ? &madt : NULL;
+}
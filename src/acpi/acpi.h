@@ -0,0 +1,53 @@
+#pragma once
+
+// ACPI table lookup, starting from the RSDP Limine hands over. Only what
+// interrupt routing needs is decoded: the MADT's I/O APICs and ISA
+// interrupt overrides. Tables outside the direct map (firmware often keeps
+// them in reserved memory) are mapped read-only on demand. Needs the VMM.
+
+struct limine_rsdp_response;
+
+#define ACPI_MAX_IOAPICS 8
+#define ACPI_ISA_IRQS    16
+
+// MPS INTI flags, as found in interrupt source overrides.
+#define ACPI_INTI_POLARITY_MASK 0x3
+#define ACPI_INTI_POLARITY_LOW  0x3
+#define ACPI_INTI_TRIGGER_MASK  0xC
+#define ACPI_INTI_TRIGGER_LEVEL 0xC
+
+typedef struct __attribute__((packed)) {
+    char signature[4];
+    u32  length;
+    u8   revision;
+    u8   checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    u32  oem_revision;
+    u32  creator_id;
+    u32  creator_revision;
+} AcpiHeader;
+
+typedef struct {
+    u8  id;
+    u64 address;  // Physical
+    u32 gsi_base; // First global system interrupt it handles
+} AcpiIoApic;
+
+typedef struct {
+    u32 gsi;   // Identity unless the MADT overrides it
+    u16 flags; // ACPI_INTI_*, 0 means bus default (edge, active high)
+} AcpiIsaIrq;
+
+typedef struct {
+    u32        ioapic_count;
+    AcpiIoApic ioapics[ACPI_MAX_IOAPICS];
+    AcpiIsaIrq isa_irqs[ACPI_ISA_IRQS];
+    u32        lapic_count;
+    bool       has_8259; // PCAT_COMPAT, legacy PICs are present
+} AcpiMadt;
+
+bool            acpi_init(struct limine_rsdp_response* rsdp);
+AcpiHeader*     acpi_find_table(const char* signature);
+const AcpiMadt* acpi_madt(void);
+void*           acpi_map(u64 phys, u64 size);
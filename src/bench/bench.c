@@ -0,0 +1,84 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "cpu/percpu.h"
+#include "panic.h"
+#include "bench.h"
+
+static BenchWorker worker_function;
+static u32         workers_done;
+
+// Prints numerator/denominator with two decimal places, a size of 0 is left
+// out of the name.
+void bench_report(String name, u64 size, u64 numerator, u64 denominator, String unit) {
+    if (denominator == 0) {
+        denominator = 1;
+    }
+
+    u64 hundredths = (numerator * 100) / denominator;
+
+    print_log(strlit("[bench] "));
+    print_log(name);
+    if (size != 0) {
+        print_log(strlit("."));
+        print_log_u64(size);
+    }
+
+    print_log(strlit(" "));
+    print_log_u64(hundredths / 100);
+    print_log(hundredths % 100 < 10 ? strlit(".0") : strlit("."));
+    print_log_u64(hundredths % 100);
+    print_log(strlit(" "));
+    print_log(unit);
+    print_log(strlit("\n"));
+}
+
+static void worker_entry(void* argument) {
+    worker_function((u32)(u64)argument);
+    __atomic_add_fetch(&workers_done, 1, __ATOMIC_RELEASE);
+}
+
+void bench_run_workers(String name, BenchWorker function, u32 workers) {
+    worker_function = function;
+    __atomic_store_n(&workers_done, 0, __ATOMIC_RELEASE);
+
+    for (u32 i = 0; i < workers; i++) {
+        thread_create(name, worker_entry, (void*)(u64)i, i);
+    }
+
+    while (__atomic_load_n(&workers_done, __ATOMIC_ACQUIRE) < workers) {
+        thread_sleep_ns(BENCH_POLL_US * 1000);
+    }
+}
+
+void bench_sweep_cpus(BenchRound round) {
+    u32 cpus    = percpu_count();
+    u32 workers = 1;
+
+    for (;;) {
+        round(workers);
+        if (workers == cpus) {
+            break;
+        }
+
+        workers = workers * 2 < cpus ? workers * 2 : cpus;
+    }
+}
+
+// QEMU exits with status (value << 1) | 1 on a write to the debug exit
+// port, so `make bench` expects 1. Without the device this just halts.
+void bench_finish(void) {
+    print_log(strlit("bench: done\n"));
+    serial_flush();
+    outb(BENCH_EXIT_PORT, 0);
+    hcf();
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+// In-kernel benchmarks, only built with `make KERNEL_BENCH=true`. Every
+// result is printed over serial as a single line:
+//
+//     [bench] <name>[.<size>] <value> <unit>
+//
+// so that the output of a headless QEMU run can be collected by a script.
+// `make bench` does that and compares the lines against a stored baseline.
+// The unit says which way is better: cycles, times and costs per operation
+// (cycles/op, retries/Mop) are lower-is-better, rates (ops/s, bytes/cycle)
+// higher-is-better.
+// bench_finish() ends the run by exiting QEMU through its isa-debug-exit
+// device at BENCH_EXIT_PORT.
+//
+// Multi-CPU benches run one worker per CPU with bench_run_workers(), over
+// 1, 2, 4, ... and finally all CPUs with bench_sweep_cpus(). Both sleep
+// while the workers run, so they must be called from a thread.
+
+#ifdef KERNEL_BENCH
+
+#define BENCH_EXIT_PORT 0xF4
+#define BENCH_POLL_US   100 // How often bench_run_workers() checks on its workers
+
+struct limine_framebuffer;
+
+typedef void (*BenchWorker)(u32 index); // Runs on CPU `index`
+typedef void (*BenchRound)(u32 workers);
+
+void bench_report(String name, u64 size, u64 numerator, u64 denominator, String unit);
+void bench_run_workers(String name, BenchWorker function, u32 workers);
+void bench_sweep_cpus(BenchRound round);
+void bench_finish(void);
+void mem_bench(void);
+void gfx_bench(struct limine_framebuffer* framebuffer);
+void kmalloc_bench(void);
+void sched_bench(void);
+void sync_bench(void);
+void timer_bench(void);
+void trace_bench(void);
+void vm_bench(void);
+
+#endif
@@ -0,0 +1,69 @@
+#ifdef KERNEL_BENCH
+
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "drivers/serial.h"
+#include "gfx/gfx.h"
+#include "gfx/console.h"
+#include "bench.h"
+
+#define GFX_BENCH_FRAMES 16
+#define GFX_BENCH_LINES  256
+
+// Per-pixel drawing straight into the framebuffer, the way main() used to
+// draw, kept as the reference point.
+static void fill_per_pixel(struct limine_framebuffer* framebuffer, u32 color) {
+    for (u32 y = 0; y < framebuffer->height; y++) {
+        for (u32 x = 0; x < framebuffer->width; x++) {
+            volatile u32* screen = framebuffer->address;
+            u32 pitch_per_pixel = framebuffer->pitch/(framebuffer->bpp/8);
+            screen[pitch_per_pixel*y+x] = color;
+        }
+    }
+}
+
+// Cycles per full-screen redraw, and per small redraw where the dirty rect
+// tracking should keep the copy proportional to what changed.
+void gfx_bench(struct limine_framebuffer* framebuffer) {
+    u32 width  = gfx_width();
+    u32 height = gfx_height();
+
+    u64 start = rdtsc_ordered();
+    for (u32 i = 0; i < GFX_BENCH_FRAMES; i++) {
+        fill_per_pixel(framebuffer, i * 0x010101);
+    }
+    bench_report(strlit("gfx.per_pixel_full"), 0, rdtsc_ordered() - start, GFX_BENCH_FRAMES, strlit("cycles/frame"));
+
+    start = rdtsc_ordered();
+    for (u32 i = 0; i < GFX_BENCH_FRAMES; i++) {
+        gfx_fill_rect(0, 0, width, height, i * 0x010101);
+    }
+    bench_report(strlit("gfx.fill_full"), 0, rdtsc_ordered() - start, GFX_BENCH_FRAMES, strlit("cycles/frame"));
+
+    start = rdtsc_ordered();
+    for (u32 i = 0; i < GFX_BENCH_FRAMES; i++) {
+        gfx_fill_rect(0, 0, width, height, i * 0x010101);
+        gfx_present();
+    }
+    bench_report(strlit("gfx.fill_present_full"), 0, rdtsc_ordered() - start, GFX_BENCH_FRAMES, strlit("cycles/frame"));
+
+    start = rdtsc_ordered();
+    for (u32 i = 0; i < GFX_BENCH_FRAMES; i++) {
+        gfx_fill_rect(i * 8, i * 8, 64, 64, 0xFFFFFF - i);
+        gfx_present();
+    }
+    bench_report(strlit("gfx.fill_present_64x64"), 0, rdtsc_ordered() - start, GFX_BENCH_FRAMES, strlit("cycles/frame"));
+
+    // Full console lines, once the cursor reaches the bottom every one of
+    // them scrolls.
+    String line = strlit("console bench: the quick brown fox jumps over the lazy dog 0123456789\n");
+    start = rdtsc_ordered();
+    for (u32 i = 0; i < GFX_BENCH_LINES; i++) {
+        console_write(line);
+    }
+    bench_report(strlit("gfx.console_line"), 0, rdtsc_ordered() - start, GFX_BENCH_LINES, strlit("cycles/line"));
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/kmalloc.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "cpu/percpu.h"
+#include "time/tsc.h"
+#include "bench.h"
+
+#define KMALLOC_BENCH_OPS   200000
+#define KMALLOC_BENCH_SLOTS 256
+
+static u64 failures;
+
+// Random alloc/free over a fixed set of slots: a full slot is freed, an
+// empty one gets a new block. Sizes lean small, one in 64 is a multi-page
+// block. Every block is written to, so the memory is really handed out.
+static void worker(u32 index) {
+    void* slots[KMALLOC_BENCH_SLOTS] = { 0 };
+    u64   state = (u64)index * 0x9E3779B97F4A7C15ull + 1;
+
+    for (u32 i = 0; i < KMALLOC_BENCH_OPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        u32 slot = (state >> 33) % KMALLOC_BENCH_SLOTS;
+
+        if (slots[slot] != NULL) {
+            kfree(slots[slot]);
+            slots[slot] = NULL;
+            continue;
+        }
+
+        u64 size = (state >> 40) % 64 == 0
+            ? PAGE_SIZE + (state >> 20) % (8 * PAGE_SIZE)
+            : 1 + (state >> 20) % (8u << ((state >> 50) % 8));
+
+        slots[slot] = kmalloc(size);
+        if (slots[slot] == NULL) {
+            __atomic_add_fetch(&failures, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        *(volatile u8*)slots[slot] = (u8)i;
+    }
+
+    for (u32 i = 0; i < KMALLOC_BENCH_SLOTS; i++) {
+        kfree(slots[i]);
+    }
+}
+
+static void stress(u32 workers) {
+    u64 start = tsc_read();
+    bench_run_workers(strlit("kmalloc-bench"), worker, workers);
+
+    u64 ops = (u64)workers * KMALLOC_BENCH_OPS;
+    bench_report(strlit("kmalloc.stress"), workers, ops * 1000000000, tsc_to_ns(tsc_read() - start), strlit("ops/s"));
+}
+
+// The same per-worker load on every CPU count bench_sweep_cpus() tries.
+void kmalloc_bench(void) {
+    bench_sweep_cpus(stress);
+
+    if (failures != 0) {
+        print_log(strlit("kmalloc_bench: allocations failed: "));
+        print_log_u64(failures);
+        print_log(strlit("\n"));
+    }
+
+    kmalloc_print_stats();
+}
+
+#endif
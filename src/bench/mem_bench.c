@@ -0,0 +1,73 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "drivers/serial.h"
+#include "mem.h"
+#include "bench.h"
+
+#define MEM_BENCH_MAX_SIZE     KB(64)
+#define MEM_BENCH_BYTES_PER_OP MB(1)
+
+static u8 bench_src[MEM_BENCH_MAX_SIZE + 64];
+static u8 bench_dst[MEM_BENCH_MAX_SIZE + 64];
+
+static const u64 size_classes[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+
+// The byte-at-a-time loop the kernel used before, kept as the reference
+// point. The volatile stops the compiler from turning it into a memcpy.
+static void byte_copy(void* dest, const void* src, u64 n) {
+    volatile u8* pdest = (volatile u8*)dest;
+    const u8* psrc = (const u8*)src;
+
+    for (u64 i = 0; i < n; i++) {
+        pdest[i] = psrc[i];
+    }
+}
+
+// Runs `expr` enough times to touch roughly MEM_BENCH_BYTES_PER_OP bytes and
+// reports the throughput, after one untimed warm-up pass.
+#define MEM_BENCH_RUN(name, size, expr) do { \
+    u64 iterations = MEM_BENCH_BYTES_PER_OP / (size); \
+    if (iterations < 64) { \
+        iterations = 64; \
+    } \
+    expr; \
+    u64 start = rdtsc_ordered(); \
+    for (u64 it = 0; it < iterations; it++) { \
+        expr; \
+    } \
+    u64 cycles = rdtsc_ordered() - start; \
+    bench_report(strlit(name), (size), iterations * (size), cycles, strlit("bytes/cycle")); \
+} while (0)
+
+void mem_bench(void) {
+    MemFeatures features = mem_features();
+    print_log(strlit("mem_bench: erms="));
+    print_log_u64(features.erms);
+    print_log(strlit(" fsrm="));
+    print_log_u64(features.fsrm);
+    print_log(strlit("\n"));
+
+    for (u64 i = 0; i < MEM_BENCH_MAX_SIZE + 64; i++) {
+        bench_src[i] = (u8)i;
+    }
+
+    volatile int sink = 0;
+
+    for (u32 i = 0; i < ArrayCount(size_classes); i++) {
+        u64 size = size_classes[i];
+
+        MEM_BENCH_RUN("mem.byte_loop",        size, byte_copy(bench_dst, bench_src, size));
+        MEM_BENCH_RUN("mem.memcpy",           size, memcpy(bench_dst, bench_src, size));
+        MEM_BENCH_RUN("mem.memcpy_unaligned", size, memcpy(bench_dst+3, bench_src+1, size));
+        MEM_BENCH_RUN("mem.memset",           size, memset(bench_dst, 0xAB, size));
+        MEM_BENCH_RUN("mem.memmove_overlap",  size, memmove(bench_dst+8, bench_dst, size));
+
+        memcpy(bench_dst, bench_src, size);
+        MEM_BENCH_RUN("mem.memcmp",           size, sink += memcmp(bench_dst, bench_src, size));
+    }
+}
+
+#endif
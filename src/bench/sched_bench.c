@@ -0,0 +1,59 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "cpu/percpu.h"
+#include "time/tsc.h"
+#include "bench.h"
+
+#define SCHED_BENCH_THREADS    64
+#define SCHED_BENCH_ITERATIONS 200000
+#define SCHED_BENCH_YIELD_MASK 0x3FFF
+
+static u32 workers_done;
+static u64 sink;
+
+// Odd workers yield regularly, even ones only ever lose the CPU to the
+// timer, and the amount of work varies fourfold between them.
+static void worker(void* argument) {
+    u64 index = (u64)argument;
+    u64 iterations = (index % 4 + 1) * SCHED_BENCH_ITERATIONS;
+    u64 state = index;
+
+    for (u64 i = 0; i < iterations; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        if ((index & 1) && (i & SCHED_BENCH_YIELD_MASK) == 0) {
+            thread_yield();
+        }
+    }
+
+    __atomic_add_fetch(&sink, state, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&workers_done, 1, __ATOMIC_RELEASE);
+}
+
+// Every worker starts on CPU 0, the other CPUs only get work by stealing.
+// Waits for the workers by yielding, so it must run in a thread of its own
+// rather than in a CPU's idle context.
+void sched_bench(void) {
+    u64 start = tsc_read();
+
+    for (u64 i = 0; i < SCHED_BENCH_THREADS; i++) {
+        thread_create(strlit("sched-bench"), worker, (void*)i, 0);
+    }
+
+    while (__atomic_load_n(&workers_done, __ATOMIC_ACQUIRE) < SCHED_BENCH_THREADS) {
+        thread_yield();
+    }
+
+    u64 cycles = tsc_read() - start;
+    bench_report(strlit("sched.mixed_load_us"), percpu_count(), tsc_to_ns(cycles), 1000, strlit("us"));
+    sched_print_stats();
+}
+
+#endif
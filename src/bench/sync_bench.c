@@ -0,0 +1,269 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "mm/kmalloc.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "cpu/percpu.h"
+#include "sync/seqlock.h"
+#include "sync/rcu.h"
+#include "time/tsc.h"
+#include "bench.h"
+
+#define SYNC_BENCH_LOCK_OPS  100000
+#define SYNC_BENCH_READ_OPS  200000
+#define SYNC_BENCH_WRITE_GAP 64 // Pauses between seqlock writes
+#define SYNC_BENCH_ENTRIES   64
+
+#define GOLDEN 0x9E3779B97F4A7C15ull
+
+typedef struct {
+    u64 key;
+    u64 value; // key * GOLDEN while live, 0 once retired
+} Entry;
+
+static BenchWorker worker_function;
+static u32         worker_count;
+static u32         workers_ready;
+static u32         workers_done;
+static u32         readers_done;
+static bool        go;
+static u64         start_tsc;
+static u64         end_tsc;
+static u64         read_cycles;  // Summed over the readers
+static u64         write_cycles; // Spent in the writer's updates
+static u64         writes;
+static u64         retries;
+static u64         errors;
+
+static Spinlock ticket_lock;
+static McsLock  queue_lock;
+static u64      shared_counter;
+
+static Seqlock  sequence_lock;
+static u64      sequence_data[2]; // Equal outside a write
+
+static Entry*   table[SYNC_BENCH_ENTRIES];
+
+// Workers start together, the last one in takes the start time and the
+// last one out the end time.
+static void worker_entry(u32 index) {
+    if (__atomic_add_fetch(&workers_ready, 1, __ATOMIC_ACQ_REL) == worker_count) {
+        start_tsc = rdtsc_ordered();
+        __atomic_store_n(&go, true, __ATOMIC_RELEASE);
+    }
+
+    while (!__atomic_load_n(&go, __ATOMIC_ACQUIRE)) {
+        cpu_pause();
+    }
+
+    worker_function(index);
+
+    if (__atomic_add_fetch(&workers_done, 1, __ATOMIC_ACQ_REL) == worker_count) {
+        end_tsc = rdtsc_ordered();
+    }
+}
+
+static void run_workers(BenchWorker function, u32 workers) {
+    worker_function = function;
+    worker_count    = workers;
+    workers_ready   = 0;
+    workers_done    = 0;
+    readers_done    = 0;
+    read_cycles     = 0;
+    write_cycles    = 0;
+    writes          = 0;
+    retries         = 0;
+    errors          = 0;
+    __atomic_store_n(&go, false, __ATOMIC_RELEASE);
+
+    bench_run_workers(strlit("sync-bench"), worker_entry, workers);
+}
+
+// Interrupts stay off for the loop so a holder is never preempted, which
+// would measure the scheduler instead of the lock.
+static void ticket_worker(u32 index) {
+    u64 flags = interrupts_save();
+    for (u32 i = 0; i < SYNC_BENCH_LOCK_OPS; i++) {
+        spin_lock(&ticket_lock);
+        shared_counter++;
+        spin_unlock(&ticket_lock);
+    }
+    interrupts_restore(flags);
+}
+
+static void mcs_worker(u32 index) {
+    u64 flags = interrupts_save();
+    for (u32 i = 0; i < SYNC_BENCH_LOCK_OPS; i++) {
+        McsNode node;
+        mcs_lock(&queue_lock, &node);
+        shared_counter++;
+        mcs_unlock(&queue_lock, &node);
+    }
+    interrupts_restore(flags);
+}
+
+static void lock_bench(String name, BenchWorker function, u32 workers) {
+    shared_counter = 0;
+    run_workers(function, workers);
+
+    u64 ops = (u64)workers * SYNC_BENCH_LOCK_OPS;
+    bench_report(name, workers, end_tsc - start_tsc, ops, strlit("cycles/op"));
+    if (shared_counter != ops) {
+        print_log(name);
+        print_log(strlit(": lost updates, mutual exclusion is broken\n"));
+    }
+}
+
+// With more than one worker, worker 0 is the writer and keeps going until
+// every reader is done.
+static void seqlock_worker(u32 index) {
+    if (index == 0 && worker_count > 1) {
+        while (__atomic_load_n(&readers_done, __ATOMIC_ACQUIRE) < worker_count - 1) {
+            u64 flags = write_seqlock(&sequence_lock);
+            sequence_data[0]++;
+            sequence_data[1]++;
+            write_sequnlock(&sequence_lock, flags);
+            writes++;
+
+            for (u32 i = 0; i < SYNC_BENCH_WRITE_GAP; i++) {
+                cpu_pause();
+            }
+        }
+        return;
+    }
+
+    u64 retried = 0;
+    u64 broken  = 0;
+    u64 start   = rdtsc_ordered();
+    for (u32 i = 0; i < SYNC_BENCH_READ_OPS; i++) {
+        u32 sequence;
+        u64 first;
+        u64 second;
+        for (;;) {
+            sequence = read_seqbegin(&sequence_lock);
+            first    = sequence_data[0];
+            second   = sequence_data[1];
+            if (!read_seqretry(&sequence_lock, sequence)) {
+                break;
+            }
+            retried++;
+        }
+
+        broken += first != second;
+    }
+
+    __atomic_add_fetch(&read_cycles, rdtsc_ordered() - start, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&retries, retried, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&errors, broken, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&readers_done, 1, __ATOMIC_RELEASE);
+}
+
+// Readers look up random entries and check them, the writer replaces
+// entries and poisons the old one once synchronize_rcu() says no reader
+// can still hold it.
+static void rcu_worker(u32 index) {
+    u64 state = index * GOLDEN + 1;
+
+    if (index == 0 && worker_count > 1) {
+        while (__atomic_load_n(&readers_done, __ATOMIC_ACQUIRE) < worker_count - 1) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            u32 key = (state >> 33) % SYNC_BENCH_ENTRIES;
+
+            Entry* fresh = kmalloc(sizeof(Entry));
+            if (fresh == NULL) {
+                errors++;
+                break;
+            }
+
+            fresh->key   = key;
+            fresh->value = key * GOLDEN;
+
+            u64 start = rdtsc_ordered();
+            Entry* old = table[key];
+            rcu_assign_pointer(table[key], fresh);
+            synchronize_rcu();
+            write_cycles += rdtsc_ordered() - start;
+            writes++;
+
+            old->value = 0;
+            kfree(old);
+        }
+        return;
+    }
+
+    u64 broken = 0;
+    u64 start  = rdtsc_ordered();
+    for (u32 i = 0; i < SYNC_BENCH_READ_OPS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        u32 key = (state >> 33) % SYNC_BENCH_ENTRIES;
+
+        u64 flags = rcu_read_lock();
+        Entry* entry = rcu_dereference(table[key]);
+        broken += entry->key != key || entry->value != key * GOLDEN;
+        rcu_read_unlock(flags);
+    }
+
+    __atomic_add_fetch(&read_cycles, rdtsc_ordered() - start, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&errors, broken, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&readers_done, 1, __ATOMIC_RELEASE);
+}
+
+static void report_readers(String name, u32 workers) {
+    u32 readers = workers > 1 ? workers - 1 : 1;
+    bench_report(name, workers, read_cycles, (u64)readers * SYNC_BENCH_READ_OPS, strlit("cycles/op"));
+    if (errors != 0) {
+        print_log(name);
+        print_log(strlit(": readers saw inconsistent data: "));
+        print_log_u64(errors);
+        print_log(strlit("\n"));
+    }
+}
+
+// The lock benches are pure contention, every worker hammering one lock.
+// For the seqlock and RCU one of the CPUs writes while the rest read.
+static void sync_round(u32 workers) {
+    lock_bench(strlit("sync.ticket"), ticket_worker, workers);
+    lock_bench(strlit("sync.mcs"), mcs_worker, workers);
+
+    run_workers(seqlock_worker, workers);
+    report_readers(strlit("sync.seqlock.read"), workers);
+    if (writes != 0) {
+        bench_report(strlit("sync.seqlock.retry"), workers, retries * 1000000, (u64)(workers - 1) * SYNC_BENCH_READ_OPS, strlit("retries/Mop"));
+    }
+
+    run_workers(rcu_worker, workers);
+    report_readers(strlit("sync.rcu.read"), workers);
+    if (writes != 0) {
+        bench_report(strlit("sync.rcu.synchronize"), workers, write_cycles, writes, strlit("cycles/op"));
+    }
+}
+
+// Each primitive on every CPU count bench_sweep_cpus() tries.
+void sync_bench(void) {
+    for (u32 i = 0; i < SYNC_BENCH_ENTRIES; i++) {
+        table[i] = kmalloc(sizeof(Entry));
+        if (table[i] == NULL) {
+            print_log(strlit("sync_bench: out of memory\n"));
+            return;
+        }
+
+        table[i]->key   = i;
+        table[i]->value = i * GOLDEN;
+    }
+
+    bench_sweep_cpus(sync_round);
+
+    for (u32 i = 0; i < SYNC_BENCH_ENTRIES; i++) {
+        kfree(table[i]);
+    }
+
+    rcu_print_stats();
+}
+
+#endif
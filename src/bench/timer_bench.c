@@ -0,0 +1,67 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "drivers/serial.h"
+#include "sched/sched.h"
+#include "time/tsc.h"
+#include "time/timer.h"
+#include "bench.h"
+
+#define TIMER_BENCH_TIMERS 1024
+#define TIMER_BENCH_SLEEPS 32
+#define TIMER_BENCH_SLEEP_US 1000
+
+static Timer timers[TIMER_BENCH_TIMERS];
+static u32   timers_fired;
+
+static void count_fired(Timer* timer) {
+    timers_fired++;
+}
+
+// Arming and cancelling with deadlines spread over every wheel level,
+// nothing is due during the measurement. Then how late thread_sleep_ns()
+// comes back. Sleeps, so it must run in a thread.
+void timer_bench(void) {
+    u64 state = 1;
+    u64 now   = tsc_read();
+
+    for (u32 i = 0; i < TIMER_BENCH_TIMERS; i++) {
+        timer_setup(&timers[i], count_fired, NULL);
+    }
+
+    u64 flags = interrupts_save();
+    u64 start = rdtsc_ordered();
+    for (u32 i = 0; i < TIMER_BENCH_TIMERS; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        u64 delay_ns = 1000000 + (state >> 33) % (1ull << (20 + i % 20)); // 1 ms and up
+        timer_arm(&timers[i], now + tsc_from_ns(delay_ns));
+    }
+    u64 arm_cycles = rdtsc_ordered() - start;
+
+    start = rdtsc_ordered();
+    for (u32 i = 0; i < TIMER_BENCH_TIMERS; i++) {
+        timer_cancel(&timers[i]);
+    }
+    u64 cancel_cycles = rdtsc_ordered() - start;
+    interrupts_restore(flags);
+
+    bench_report(strlit("timer.arm"), TIMER_BENCH_TIMERS, arm_cycles, TIMER_BENCH_TIMERS, strlit("cycles/op"));
+    bench_report(strlit("timer.cancel"), TIMER_BENCH_TIMERS, cancel_cycles, TIMER_BENCH_TIMERS, strlit("cycles/op"));
+    if (timers_fired != 0) {
+        print_log(strlit("timer_bench: a cancelled timer fired\n"));
+    }
+
+    u64 late = 0;
+    for (u32 i = 0; i < TIMER_BENCH_SLEEPS; i++) {
+        u64 deadline = tsc_read() + tsc_from_ns(TIMER_BENCH_SLEEP_US * 1000);
+        thread_sleep_ns(TIMER_BENCH_SLEEP_US * 1000);
+        late += tsc_read() - deadline;
+    }
+
+    bench_report(strlit("timer.sleep_late_ns"), TIMER_BENCH_SLEEP_US, tsc_to_ns(late), TIMER_BENCH_SLEEPS, strlit("ns"));
+    timer_print_stats();
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "trace/trace.h"
+#include "mem.h"
+#include "bench.h"
+
+#define TRACE_BENCH_ITERATIONS 100000
+
+// Cost of one tracepoint with tracing on and off. The ring wraps many
+// times over, which is the steady state of a long running kernel.
+void trace_bench(void) {
+    bool enabled = trace_enabled;
+
+    trace_enabled = true;
+    u64 start = rdtsc_ordered();
+    for (u64 i = 0; i < TRACE_BENCH_ITERATIONS; i++) {
+        TRACE(IRQ, 0, i);
+    }
+    u64 cycles = rdtsc_ordered() - start;
+    bench_report(strlit("trace.record_enabled"), 0, cycles, TRACE_BENCH_ITERATIONS, strlit("cycles/op"));
+
+    trace_enabled = false;
+    start = rdtsc_ordered();
+    for (u64 i = 0; i < TRACE_BENCH_ITERATIONS; i++) {
+        TRACE(IRQ, 0, i);
+    }
+    cycles = rdtsc_ordered() - start;
+    bench_report(strlit("trace.record_disabled"), 0, cycles, TRACE_BENCH_ITERATIONS, strlit("cycles/op"));
+
+    // Drop the bench records so they don't bury the real ones in the dump.
+    TraceRing* ring = this_cpu()->trace_ring;
+    if (ring != NULL) {
+        u64 flags = interrupts_save();
+        memset(ring, 0, sizeof(TraceRing));
+        interrupts_restore(flags);
+    }
+
+    trace_enabled = enabled;
+}
+
+#endif
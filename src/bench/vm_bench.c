@@ -0,0 +1,62 @@
+#ifdef KERNEL_BENCH
+
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "mm/vm.h"
+#include "panic.h"
+#include "bench.h"
+
+#define VM_BENCH_PAGES 256
+
+static u64 touch_pages(u8* base, u64 pages, u8 value) {
+    u64 start = rdtsc_ordered();
+    for (u64 i = 0; i < pages; i++) {
+        base[i * PAGE_SIZE] = value;
+    }
+    return rdtsc_ordered() - start;
+}
+
+// First touch of lazy pages, once as the pool allows and once with the pool
+// full, then the cost of breaking copy-on-write shares. Also checks that the copy and
+// the original really diverge.
+void vm_bench(void) {
+    u8* cold = vm_reserve(VM_BENCH_PAGES, VMM_FLAG_WRITE);
+    u8* warm = vm_reserve(VM_BENCH_PAGES, VMM_FLAG_WRITE);
+    if (cold == NULL || warm == NULL) {
+        print_log(strlit("vm_bench: out of memory\n"));
+        return;
+    }
+
+    u64 cycles = touch_pages(cold, VM_BENCH_PAGES, 1);
+    bench_report(strlit("vm.fault_in"), 0, cycles, VM_BENCH_PAGES, strlit("cycles/page"));
+
+    // A full pool covers VM_ZERO_POOL_SIZE faults.
+    for (u32 i = 0; i < VM_ZERO_POOL_SIZE / VM_REFILL_BATCH; i++) {
+        vm_idle_refill();
+    }
+    cycles = touch_pages(warm, VM_ZERO_POOL_SIZE, 2);
+    bench_report(strlit("vm.fault_in_pooled"), 0, cycles, VM_ZERO_POOL_SIZE, strlit("cycles/page"));
+
+    u8* copy = vm_duplicate(cold);
+    Assert(copy != NULL);
+    cycles = touch_pages(copy, VM_BENCH_PAGES, 3);
+    bench_report(strlit("vm.cow_copy"), 0, cycles, VM_BENCH_PAGES, strlit("cycles/page"));
+
+    cycles = touch_pages(cold, VM_BENCH_PAGES, 4);
+    bench_report(strlit("vm.cow_reuse"), 0, cycles, VM_BENCH_PAGES, strlit("cycles/page"));
+
+    for (u64 i = 0; i < VM_BENCH_PAGES; i++) {
+        Assert(cold[i * PAGE_SIZE] == 4 && copy[i * PAGE_SIZE] == 3 && cold[i * PAGE_SIZE + 1] == 0);
+    }
+
+    vm_release(copy);
+    vm_release(warm);
+    vm_release(cold);
+    vm_print_stats();
+}
+
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+
+// Thin wrappers around the x86_64 instructions the rest of the kernel needs.
+// These are static inline so that hot paths (rdtsc, cpuid feature checks)
+// don't pay for a call at -O0.
+
+#define CPUID_1_ECX_TSC_DEADLINE (1 << 24)
+#define CPUID_7_EBX_ERMS (1 << 9)  // Enhanced rep movsb/stosb
+#define CPUID_7_EDX_FSRM (1 << 4)  // Fast short rep movsb
+
+typedef struct {
+    u32 eax;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+} CpuidResult;
+
+static inline CpuidResult cpuid(u32 leaf, u32 subleaf) {
+    CpuidResult result;
+    asm volatile (
+            "cpuid"
+            : "=a" (result.eax), "=b" (result.ebx), "=c" (result.ecx), "=d" (result.edx)
+            : "a" (leaf), "c" (subleaf)
+    );
+    return result;
+}
+
+static inline u32 cpuid_max_leaf(void) {
+    return cpuid(0, 0).eax;
+}
+
+static inline u64 rdtsc(void) {
+    u32 low, high;
+    asm volatile (
+            "rdtsc"
+            : "=a" (low), "=d" (high)
+    );
+    return ((u64)high << 32) | low;
+}
+
+// Ordered variant of rdtsc: the lfence keeps the timestamp from being taken
+// before earlier instructions (the work being measured) have completed.
+static inline u64 rdtsc_ordered(void) {
+    u32 low, high;
+    asm volatile (
+            "lfence\n"
+            "rdtsc"
+            : "=a" (low), "=d" (high)
+            :
+            : "memory"
+    );
+    return ((u64)high << 32) | low;
+}
+
+// rdtscp waits for earlier instructions itself and also returns IA32_TSC_AUX,
+// check CPUID_EXT_EDX_RDTSCP before using it.
+static inline u64 rdtscp(u32* aux) {
+    u32 low, high, tsc_aux;
+    asm volatile (
+            "rdtscp"
+            : "=a" (low), "=d" (high), "=c" (tsc_aux)
+            :
+            : "memory"
+    );
+    if (aux != NULL) {
+        *aux = tsc_aux;
+    }
+    return ((u64)high << 32) | low;
+}
+
+static inline void cpu_pause(void) {
+    asm volatile ("pause" ::: "memory");
+}
+
+#define CPUID_EXT_EDX_NX      (1 << 20)
+#define CPUID_EXT_EDX_PAGE1GB (1 << 26)
+#define CPUID_EXT_EDX_RDTSCP  (1 << 27)
+
+#define CPUID_APM_EDX_INVARIANT_TSC (1 << 8) // Leaf 0x80000007
+
+#define MSR_PAT  0x277
+#define MSR_EFER 0xC0000080
+
+#define EFER_NXE (1 << 11)
+#define CR0_WP   (1 << 16)
+
+static inline u64 rdmsr(u32 msr) {
+    u32 low, high;
+    asm volatile (
+            "rdmsr"
+            : "=a" (low), "=d" (high)
+            : "c" (msr)
+    );
+    return ((u64)high << 32) | low;
+}
+
+static inline void wrmsr(u32 msr, u64 value) {
+    asm volatile (
+            "wrmsr"
+            :
+            : "c" (msr), "a" ((u32)value), "d" ((u32)(value >> 32))
+            : "memory"
+    );
+}
+
+static inline u64 read_cr0(void) {
+    u64 value;
+    asm volatile ("mov %0, cr0" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr0(u64 value) {
+    asm volatile ("mov cr0, %0" :: "r" (value) : "memory");
+}
+
+static inline u64 read_cr2(void) {
+    u64 value;
+    asm volatile ("mov %0, cr2" : "=r" (value));
+    return value;
+}
+
+static inline u64 read_cr3(void) {
+    u64 value;
+    asm volatile ("mov %0, cr3" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr3(u64 value) {
+    asm volatile ("mov cr3, %0" :: "r" (value) : "memory");
+}
+
+static inline void invlpg(u64 address) {
+    asm volatile ("invlpg [%0]" :: "r" (address) : "memory");
+}
+
+#define RFLAGS_IF (1 << 9)
+
+static inline u64 read_rflags(void) {
+    u64 rflags;
+    asm volatile ("pushfq\n" "pop %0" : "=r" (rflags) :: "memory");
+    return rflags;
+}
+
+static inline bool interrupts_enabled(void) {
+    return (read_rflags() & RFLAGS_IF) != 0;
+}
+
+static inline void interrupts_enable(void) {
+    asm volatile ("sti" ::: "memory");
+}
+
+static inline void interrupts_disable(void) {
+    asm volatile ("cli" ::: "memory");
+}
+
+// Disables interrupts and returns the previous RFLAGS for
+// interrupts_restore(), so the pair nests.
+static inline u64 interrupts_save(void) {
+    u64 rflags = read_rflags();
+    interrupts_disable();
+    return rflags;
+}
+
+static inline void interrupts_restore(u64 rflags) {
+    if (rflags & RFLAGS_IF) {
+        interrupts_enable();
+    }
+}
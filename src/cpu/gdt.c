@@ -0,0 +1,83 @@
+#include <util.h>
+#include <string.h>
+#include "panic.h"
+#include "mem.h"
+#include "mm/pmm.h"
+#include "cpu.h"
+#include "spinlock.h"
+#include "sched/run_queue.h"
+#include "gdt.h"
+#include "percpu.h"
+
+typedef struct __attribute__((packed)) {
+    u16 limit;
+    u64 base;
+} DescriptorPointer;
+
+// Reloads CS through an iretq back to our caller, the one far control
+// transfer both assemblers agree on in Intel syntax.
+__attribute__((naked)) static void reload_code_segment(void) {
+    asm (
+            "pop rdi\n"
+            "mov rax, rsp\n"
+            "push 0x10\n"   // GDT_KERNEL_DATA
+            "push rax\n"
+            "pushfq\n"
+            "push 0x08\n"   // GDT_KERNEL_CODE
+            "push rdi\n"
+            "iretq\n"
+    );
+}
+
+void gdt_init_cpu(Gdt* gdt) {
+    memset(gdt, 0, sizeof(Gdt));
+
+    gdt->entries[GDT_KERNEL_CODE / 8] = 0x00AF9A000000FFFF;
+    gdt->entries[GDT_KERNEL_DATA / 8] = 0x00CF92000000FFFF;
+    gdt->entries[GDT_USER_DATA   / 8] = 0x00CFF2000000FFFF;
+    gdt->entries[GDT_USER_CODE   / 8] = 0x00AFFA000000FFFF;
+
+    for (u32 i = 0; i < IST_COUNT; i++) {
+        u64 stack = pmm_alloc_pages(IST_STACK_SIZE / PAGE_SIZE);
+        if (stack == 0) {
+            panic(strlit("gdt: out of memory allocating IST stacks"));
+        }
+
+        gdt->tss.ist[i] = (u64)phys_to_virt(stack) + IST_STACK_SIZE;
+    }
+
+    gdt->tss.iomap_base = sizeof(Tss);
+
+    // 64-bit available TSS, the descriptor takes two slots.
+    u64 tss_base  = (u64)&gdt->tss;
+    u64 tss_limit = sizeof(Tss) - 1;
+    gdt->entries[GDT_TSS / 8] = (tss_limit & 0xFFFF) |
+                                ((tss_base & 0xFFFFFF) << 16) |
+                                ((u64)0x89 << 40) |
+                                (((tss_limit >> 16) & 0xF) << 48) |
+                                (((tss_base >> 24) & 0xFF) << 56);
+    gdt->entries[GDT_TSS / 8 + 1] = tss_base >> 32;
+
+    DescriptorPointer pointer = { sizeof(gdt->entries) - 1, (u64)gdt->entries };
+    asm volatile ("lgdt [%0]" :: "r" (&pointer) : "memory");
+
+    reload_code_segment();
+
+    // FS and GS are left alone, their bases live in MSRs and loading a
+    // selector would clear them.
+    asm volatile (
+            "mov ds, %0\n"
+            "mov es, %0\n"
+            "mov ss, %0\n"
+            :
+            : "r" ((u16)GDT_KERNEL_DATA)
+            : "memory"
+    );
+
+    asm volatile ("ltr %0" :: "r" ((u16)GDT_TSS) : "memory");
+}
+
+// Loads the calling CPU's own GDT and TSS from its PerCpu block.
+void gdt_init(void) {
+    gdt_init_cpu(&this_cpu()->gdt);
+}
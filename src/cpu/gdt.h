@@ -0,0 +1,36 @@
+#pragma once
+
+#define GDT_KERNEL_CODE 0x08
+#define GDT_KERNEL_DATA 0x10
+#define GDT_USER_DATA   0x18
+#define GDT_USER_CODE   0x20
+#define GDT_TSS         0x28
+
+// Interrupt stack table slots, the stacks these exceptions run on are
+// separate so a blown kernel stack still reaches the handler.
+#define IST_DOUBLE_FAULT  1
+#define IST_NMI           2
+#define IST_MACHINE_CHECK 3
+#define IST_COUNT         3
+#define IST_STACK_SIZE    KB(16)
+
+#define GDT_ENTRY_COUNT 7 // null, 4 segments, 16 byte TSS descriptor
+
+typedef struct __attribute__((packed)) {
+    u32 reserved0;
+    u64 rsp[3];
+    u64 reserved1;
+    u64 ist[7];
+    u64 reserved2;
+    u16 reserved3;
+    u16 iomap_base;
+} Tss;
+
+// Every CPU needs its own, the TSS descriptor is marked busy once loaded.
+typedef struct {
+    u64 entries[GDT_ENTRY_COUNT];
+    Tss tss;
+} Gdt;
+
+void gdt_init(void);
+void gdt_init_cpu(Gdt* gdt);
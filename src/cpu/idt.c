@@ -0,0 +1,244 @@
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "panic.h"
+#include "cpu.h"
+#include "gdt.h"
+#include "idt.h"
+#include "spinlock.h"
+#include "sched/run_queue.h"
+#include "percpu.h"
+#include "sched/sched.h"
+#include "trace/trace.h"
+
+typedef struct __attribute__((packed)) {
+    u16 offset_low;
+    u16 selector;
+    u8  ist;
+    u8  type_attributes;
+    u16 offset_mid;
+    u32 offset_high;
+    u32 reserved;
+} IdtEntry;
+
+typedef struct __attribute__((packed)) {
+    u16 limit;
+    u64 base;
+} IdtPointer;
+
+#define IDT_INTERRUPT_GATE 0x8E // Present, ring 0, interrupts off on entry
+
+static IdtEntry         idt[256];
+static InterruptHandler handlers[256];
+
+static const String exception_names[32] = {
+    strlit("divide error"),        strlit("debug"),
+    strlit("NMI"),                 strlit("breakpoint"),
+    strlit("overflow"),            strlit("bound range exceeded"),
+    strlit("invalid opcode"),      strlit("device not available"),
+    strlit("double fault"),        strlit("coprocessor segment overrun"),
+    strlit("invalid TSS"),         strlit("segment not present"),
+    strlit("stack segment fault"), strlit("general protection fault"),
+    strlit("page fault"),          strlit("reserved"),
+    strlit("x87 floating point"),  strlit("alignment check"),
+    strlit("machine check"),       strlit("SIMD floating point"),
+    strlit("virtualization"),      strlit("control protection"),
+    strlit("reserved"),            strlit("reserved"),
+    strlit("reserved"),            strlit("reserved"),
+    strlit("reserved"),            strlit("reserved"),
+    strlit("hypervisor injection"), strlit("VMM communication"),
+    strlit("security exception"),  strlit("reserved")
+};
+
+// interrupt_dispatch and interrupt_common are only referenced from asm
+// strings, which LTO can't see into, so both are marked used.
+__attribute__((used)) void interrupt_dispatch(InterruptFrame* frame);
+
+// Only the registers a C function may clobber are saved, the handler
+// restores the callee-saved ones itself. The CPU aligned RSP to 16 before
+// pushing its frame, 2 + 9 pushes keep the call below ABI-aligned.
+__attribute__((naked, used)) void interrupt_common(void) {
+    asm (
+            "push rax\n"
+            "push rcx\n"
+            "push rdx\n"
+            "push rsi\n"
+            "push rdi\n"
+            "push r8\n"
+            "push r9\n"
+            "push r10\n"
+            "push r11\n"
+            "mov rdi, rsp\n"
+            "cld\n"
+            "call interrupt_dispatch\n"
+            "pop r11\n"
+            "pop r10\n"
+            "pop r9\n"
+            "pop r8\n"
+            "pop rdi\n"
+            "pop rsi\n"
+            "pop rdx\n"
+            "pop rcx\n"
+            "pop rax\n"
+            "add rsp, 16\n"
+            "iretq\n"
+    );
+}
+
+#define ISR_STUB(vector) \
+    __attribute__((naked)) static void isr_stub_##vector(void) { \
+        asm ("push 0\n" "push " #vector "\n" "jmp interrupt_common\n"); \
+    }
+
+// The CPU already pushed an error code for these.
+#define ISR_STUB_ERROR(vector) \
+    __attribute__((naked)) static void isr_stub_##vector(void) { \
+        asm ("push " #vector "\n" "jmp interrupt_common\n"); \
+    }
+
+#define ISR_STUB_ROW(hi) \
+    ISR_STUB(0x##hi##0) ISR_STUB(0x##hi##1) ISR_STUB(0x##hi##2) ISR_STUB(0x##hi##3) \
+    ISR_STUB(0x##hi##4) ISR_STUB(0x##hi##5) ISR_STUB(0x##hi##6) ISR_STUB(0x##hi##7) \
+    ISR_STUB(0x##hi##8) ISR_STUB(0x##hi##9) ISR_STUB(0x##hi##A) ISR_STUB(0x##hi##B) \
+    ISR_STUB(0x##hi##C) ISR_STUB(0x##hi##D) ISR_STUB(0x##hi##E) ISR_STUB(0x##hi##F)
+
+#define ISR_STUB_POINTER_ROW(hi) \
+    isr_stub_0x##hi##0, isr_stub_0x##hi##1, isr_stub_0x##hi##2, isr_stub_0x##hi##3, \
+    isr_stub_0x##hi##4, isr_stub_0x##hi##5, isr_stub_0x##hi##6, isr_stub_0x##hi##7, \
+    isr_stub_0x##hi##8, isr_stub_0x##hi##9, isr_stub_0x##hi##A, isr_stub_0x##hi##B, \
+    isr_stub_0x##hi##C, isr_stub_0x##hi##D, isr_stub_0x##hi##E, isr_stub_0x##hi##F
+
+ISR_STUB(0x00)       ISR_STUB(0x01)       ISR_STUB(0x02)       ISR_STUB(0x03)
+ISR_STUB(0x04)       ISR_STUB(0x05)       ISR_STUB(0x06)       ISR_STUB(0x07)
+ISR_STUB_ERROR(0x08) ISR_STUB(0x09)       ISR_STUB_ERROR(0x0A) ISR_STUB_ERROR(0x0B)
+ISR_STUB_ERROR(0x0C) ISR_STUB_ERROR(0x0D) ISR_STUB_ERROR(0x0E) ISR_STUB(0x0F)
+ISR_STUB(0x10)       ISR_STUB_ERROR(0x11) ISR_STUB(0x12)       ISR_STUB(0x13)
+ISR_STUB(0x14)       ISR_STUB_ERROR(0x15) ISR_STUB(0x16)       ISR_STUB(0x17)
+ISR_STUB(0x18)       ISR_STUB(0x19)       ISR_STUB(0x1A)       ISR_STUB(0x1B)
+ISR_STUB(0x1C)       ISR_STUB_ERROR(0x1D) ISR_STUB_ERROR(0x1E) ISR_STUB(0x1F)
+
+ISR_STUB_ROW(2) ISR_STUB_ROW(3) ISR_STUB_ROW(4) ISR_STUB_ROW(5)
+ISR_STUB_ROW(6) ISR_STUB_ROW(7) ISR_STUB_ROW(8) ISR_STUB_ROW(9)
+ISR_STUB_ROW(A) ISR_STUB_ROW(B) ISR_STUB_ROW(C) ISR_STUB_ROW(D)
+ISR_STUB_ROW(E) ISR_STUB_ROW(F)
+
+static void (*const isr_stubs[256])(void) = {
+    ISR_STUB_POINTER_ROW(0), ISR_STUB_POINTER_ROW(1), ISR_STUB_POINTER_ROW(2), ISR_STUB_POINTER_ROW(3),
+    ISR_STUB_POINTER_ROW(4), ISR_STUB_POINTER_ROW(5), ISR_STUB_POINTER_ROW(6), ISR_STUB_POINTER_ROW(7),
+    ISR_STUB_POINTER_ROW(8), ISR_STUB_POINTER_ROW(9), ISR_STUB_POINTER_ROW(A), ISR_STUB_POINTER_ROW(B),
+    ISR_STUB_POINTER_ROW(C), ISR_STUB_POINTER_ROW(D), ISR_STUB_POINTER_ROW(E), ISR_STUB_POINTER_ROW(F)
+};
+
+static void set_gate(u8 vector, void (*stub)(void), u8 ist) {
+    u64 offset = (u64)stub;
+    idt[vector] = (IdtEntry) {
+        .offset_low      = offset & 0xFFFF,
+        .selector        = GDT_KERNEL_CODE,
+        .ist             = ist,
+        .type_attributes = IDT_INTERRUPT_GATE,
+        .offset_mid      = (offset >> 16) & 0xFFFF,
+        .offset_high     = offset >> 32
+    };
+}
+
+// Also the way out for handlers that find they can't deal with an exception
+// after all, the page fault handler for one.
+void unhandled_exception(InterruptFrame* frame) {
+    serial_force_polled();
+    print_log(strlit("PANIC: unhandled "));
+    print_log(exception_names[frame->vector]);
+    print_log(strlit(" (vector "));
+    print_log_u64(frame->vector);
+    print_log(strlit(") error_code="));
+    print_log_hex(frame->error_code);
+    print_log(strlit(" rip="));
+    print_log_hex(frame->rip);
+    print_log(strlit(" rsp="));
+    print_log_hex(frame->rsp);
+    if (frame->vector == VECTOR_PAGE_FAULT) {
+        print_log(strlit(" cr2="));
+        print_log_hex(read_cr2());
+    }
+
+    print_log(strlit("\n"));
+    hcf();
+}
+
+void interrupt_dispatch(InterruptFrame* frame) {
+    u64 start = rdtsc();
+    TRACE(IRQ, frame->vector, frame->rip);
+
+    InterruptHandler handler = handlers[frame->vector];
+    if (handler != NULL) {
+        handler(frame);
+    }
+    else if (frame->vector < VECTOR_IRQ_BASE) {
+        unhandled_exception(frame);
+    }
+
+    // Interrupts are still off, nothing else touches this CPU's stats.
+    u64 cycles = rdtsc() - start;
+    InterruptStats* stats = &this_cpu()->interrupt_stats[frame->vector];
+    stats->count++;
+    stats->cycles += cycles;
+    if (cycles > stats->max_cycles) {
+        stats->max_cycles = cycles;
+    }
+
+    // Never from an exception, an NMI in the middle of the timer handler
+    // would otherwise switch threads on its IST stack.
+    if (frame->vector >= VECTOR_IRQ_BASE) {
+        sched_interrupt_exit();
+    }
+}
+
+void idt_init(void) {
+    for (u32 vector = 0; vector < 256; vector++) {
+        set_gate(vector, isr_stubs[vector], 0);
+    }
+
+    set_gate(VECTOR_DOUBLE_FAULT,  isr_stubs[VECTOR_DOUBLE_FAULT],  IST_DOUBLE_FAULT);
+    set_gate(VECTOR_NMI,           isr_stubs[VECTOR_NMI],           IST_NMI);
+    set_gate(VECTOR_MACHINE_CHECK, isr_stubs[VECTOR_MACHINE_CHECK], IST_MACHINE_CHECK);
+
+    idt_load();
+}
+
+void idt_load(void) {
+    IdtPointer pointer = { sizeof(idt) - 1, (u64)idt };
+    asm volatile ("lidt [%0]" :: "r" (&pointer) : "memory");
+}
+
+void interrupt_register(u8 vector, InterruptHandler handler) {
+    handlers[vector] = handler;
+}
+
+// Summed over the CPUs. Another CPU may be updating its counts meanwhile,
+// so the totals are only as exact as a snapshot can be.
+void interrupt_print_stats(void) {
+    for (u32 vector = 0; vector < 256; vector++) {
+        InterruptStats total = {};
+        for (u32 i = 0; i < percpu_count(); i++) {
+            InterruptStats* stats = &percpu_get(i)->interrupt_stats[vector];
+            total.count  += stats->count;
+            total.cycles += stats->cycles;
+            if (stats->max_cycles > total.max_cycles) {
+                total.max_cycles = stats->max_cycles;
+            }
+        }
+
+        if (total.count == 0) {
+            continue;
+        }
+
+        print_log(strlit("irq: vector="));
+        print_log_u64(vector);
+        print_log(strlit(" count="));
+        print_log_u64(total.count);
+        print_log(strlit(" avg_cycles="));
+        print_log_u64(total.cycles / total.count);
+        print_log(strlit(" max_cycles="));
+        print_log_u64(total.max_cycles);
+        print_log(strlit("\n"));
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Interrupt entry. Each vector has a tiny assembly stub that pushes the
+// vector number (and a dummy error code where the CPU doesn't push one) and
+// jumps to a common path that only saves the caller-saved registers, the
+// C handler preserves the rest. Handlers are looked up in a flat table.
+
+#define VECTOR_DIVIDE_ERROR       0x00
+#define VECTOR_NMI                0x02
+#define VECTOR_BREAKPOINT         0x03
+#define VECTOR_INVALID_OPCODE     0x06
+#define VECTOR_DOUBLE_FAULT       0x08
+#define VECTOR_GENERAL_PROTECTION 0x0D
+#define VECTOR_PAGE_FAULT         0x0E
+#define VECTOR_MACHINE_CHECK      0x12
+#define VECTOR_IRQ_BASE           0x20
+#define VECTOR_LAPIC_TIMER        0xEF
+#define VECTOR_IPI_WAKEUP         0xF0
+#define VECTOR_IPI_TLB_SHOOTDOWN  0xF1
+
+typedef struct {
+    u64 r11;
+    u64 r10;
+    u64 r9;
+    u64 r8;
+    u64 rdi;
+    u64 rsi;
+    u64 rdx;
+    u64 rcx;
+    u64 rax;
+
+    u64 vector;
+    u64 error_code;
+
+    // Pushed by the CPU
+    u64 rip;
+    u64 cs;
+    u64 rflags;
+    u64 rsp;
+    u64 ss;
+} InterruptFrame;
+
+typedef void (*InterruptHandler)(InterruptFrame* frame);
+
+// Kept per CPU, see PerCpu. The time is the handler's alone, a switch to
+// another thread only happens after it is taken.
+typedef struct InterruptStats {
+    u64 count;
+    u64 cycles;
+    u64 max_cycles;
+} InterruptStats;
+
+#define INTERRUPT_STATS_PAGES ((256 * sizeof(InterruptStats) + PAGE_SIZE - 1) / PAGE_SIZE)
+
+void idt_init(void);
+void idt_load(void);
+void interrupt_register(u8 vector, InterruptHandler handler);
+void interrupt_print_stats(void);
+__attribute__((noreturn)) void unhandled_exception(InterruptFrame* frame);
@@ -0,0 +1,80 @@
+#include <util.h>
+#include <string.h>
+#include "cpu.h"
+#include "gdt.h"
+#include "idt.h"
+#include "spinlock.h"
+#include "sched/run_queue.h"
+#include "mm/pmm.h"
+#include "panic.h"
+#include "mem.h"
+#include "percpu.h"
+
+_Static_assert(__builtin_offsetof(PerCpu, self) == 0, "this_cpu() reads gs:[0]");
+_Static_assert(__builtin_offsetof(PerCpu, stack_top) == 8, "ap_entry loads [cpu + 8]");
+_Static_assert(sizeof(PerCpu) <= PAGE_SIZE, "percpu_add() hands out one page");
+
+static PerCpu         bsp_cpu;
+static InterruptStats bsp_interrupt_stats[256];
+static PerCpu*        cpus[MAX_CPUS];
+static u32            cpu_count;
+
+static void percpu_setup(PerCpu* cpu, u32 cpu_id, u32 lapic_id, u64 stack_top) {
+    memset(cpu, 0, sizeof(PerCpu));
+    cpu->self      = cpu;
+    cpu->stack_top = stack_top;
+    cpu->cpu_id    = cpu_id;
+    cpu->lapic_id  = lapic_id;
+    run_queue_init(&cpu->run_queue);
+}
+
+// The bootstrap processor runs on the bootloader's stack and its LAPIC id
+// is filled in once SMP is brought up.
+void percpu_init_bsp(void) {
+    percpu_setup(&bsp_cpu, 0, 0, 0);
+    bsp_cpu.interrupt_stats = bsp_interrupt_stats;
+    bsp_cpu.online = true;
+    cpus[0]   = &bsp_cpu;
+    cpu_count = 1;
+    percpu_load(&bsp_cpu);
+}
+
+// Registers an application processor. Only called by the BSP before any AP
+// is started, so the table needs no lock.
+PerCpu* percpu_add(u32 lapic_id, u64 stack_top) {
+    if (cpu_count == MAX_CPUS) {
+        return NULL;
+    }
+
+    u64 phys = pmm_alloc_page();
+    if (phys == 0) {
+        return NULL;
+    }
+
+    u64 stats_phys = pmm_alloc_pages(INTERRUPT_STATS_PAGES);
+    if (stats_phys == 0) {
+        pmm_free_page(phys);
+        return NULL;
+    }
+
+    PerCpu* cpu = phys_to_virt(phys);
+    percpu_setup(cpu, cpu_count, lapic_id, stack_top);
+    cpu->interrupt_stats = phys_to_virt(stats_phys);
+    memset(cpu->interrupt_stats, 0, INTERRUPT_STATS_PAGES * PAGE_SIZE);
+    cpus[cpu_count++] = cpu;
+    return cpu;
+}
+
+void percpu_load(PerCpu* cpu) {
+    wrmsr(MSR_GS_BASE, (u64)cpu);
+    wrmsr(MSR_KERNEL_GS_BASE, 0);
+}
+
+u32 percpu_count(void) {
+    return cpu_count;
+}
+
+PerCpu* percpu_get(u32 cpu_id) {
+    Assert(cpu_id < cpu_count);
+    return cpus[cpu_id];
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Per-CPU state, reached through the GS base. The first word of the block
+// points at the block itself, so this_cpu() is a single gs-relative load.
+// Needs cpu/gdt.h, cpu/spinlock.h and sched/run_queue.h.
+
+struct Thread;
+struct TraceRing;
+struct TimerWheel;
+struct InterruptStats;
+
+#define MAX_CPUS       64
+#define CPU_STACK_SIZE KB(16)
+
+#define MSR_GS_BASE        0xC0000101
+#define MSR_KERNEL_GS_BASE 0xC0000102
+
+typedef struct PerCpu {
+    struct PerCpu* self;      // Must stay first, this_cpu() loads gs:[0]
+    u64            stack_top; // Must stay second, the AP entry stub loads it
+    u32            cpu_id;    // Dense, 0 is the bootstrap processor
+    u32            lapic_id;
+    bool           online;
+    Gdt            gdt;
+
+    RunQueue       run_queue;
+    SchedStats     sched_stats;
+    struct Thread* current;
+    struct Thread* idle_thread;
+    struct Thread* switch_from; // Previous thread until finish_switch() runs
+    bool           need_resched; // The time slice ran out, switch on interrupt exit
+
+    struct TraceRing*      trace_ring;
+    struct TimerWheel*     timer_wheel;
+    struct InterruptStats* interrupt_stats; // One per vector
+} PerCpu;
+
+static inline PerCpu* this_cpu(void) {
+    PerCpu* cpu;
+    asm volatile ("mov %0, qword ptr gs:[0]" : "=r" (cpu));
+    return cpu;
+}
+
+void    percpu_init_bsp(void);
+PerCpu* percpu_add(u32 lapic_id, u64 stack_top);
+void    percpu_load(PerCpu* cpu);
+u32     percpu_count(void);
+PerCpu* percpu_get(u32 cpu_id);
@@ -0,0 +1,160 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "drivers/lapic.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "time/tsc.h"
+#include "time/timer.h"
+#include "panic.h"
+#include "cpu.h"
+#include "gdt.h"
+#include "idt.h"
+#include "spinlock.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "percpu.h"
+#include "smp.h"
+#include "sync/rcu.h"
+#include "trace/trace.h"
+
+static u32      online_count = 1;
+static Spinlock shootdown_lock;
+static u32      shootdown_pending;
+
+__attribute__((used)) void ap_main(struct limine_mp_info* info);
+
+// Limine enters here on its own small stack. Switch to the stack set up in
+// our PerCpu block (info->extra_argument) before running any C.
+__attribute__((naked)) static void ap_entry(struct limine_mp_info* info) {
+    asm (
+            "mov rax, [rdi + 24]\n" // info->extra_argument
+            "mov rsp, [rax + 8]\n"  // cpu->stack_top
+            "xor ebp, ebp\n"
+            "call ap_main\n"
+            "ud2\n"
+    );
+}
+
+void ap_main(struct limine_mp_info* info) {
+    PerCpu* cpu = (PerCpu*)info->extra_argument;
+
+    vmm_init_cpu();
+    percpu_load(cpu);
+    gdt_init();
+    idt_load();
+    lapic_init_cpu();
+    sched_init_cpu();
+
+    __atomic_store_n(&cpu->online, true, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&online_count, 1, __ATOMIC_RELEASE);
+
+    sched_idle_loop();
+}
+
+// Also how synchronize_rcu() gets a quiescent state out of a CPU.
+static void wakeup_interrupt(InterruptFrame* frame) {
+    rcu_quiescent();
+    lapic_eoi();
+}
+
+static void shootdown_interrupt(InterruptFrame* frame) {
+    write_cr3(read_cr3());
+    __atomic_sub_fetch(&shootdown_pending, 1, __ATOMIC_RELEASE);
+    lapic_eoi();
+}
+
+void smp_init(struct limine_mp_response* mp) {
+    interrupt_register(VECTOR_IPI_WAKEUP,        wakeup_interrupt);
+    interrupt_register(VECTOR_IPI_TLB_SHOOTDOWN, shootdown_interrupt);
+
+    if (mp == NULL) {
+        print_log(strlit("smp: no MP response, running on the BSP only\n"));
+        return;
+    }
+
+    this_cpu()->lapic_id = mp->bsp_lapic_id;
+
+    // Set every AP up before releasing any, so the per-CPU table is final
+    // by the time something might walk it.
+    u32 expected = 1;
+    for (u64 i = 0; i < mp->cpu_count; i++) {
+        struct limine_mp_info* info = mp->cpus[i];
+        if (info->lapic_id == mp->bsp_lapic_id) {
+            continue;
+        }
+
+        u64 stack = pmm_alloc_pages(CPU_STACK_SIZE / PAGE_SIZE);
+        PerCpu* cpu = stack != 0 ? percpu_add(info->lapic_id, (u64)phys_to_virt(stack) + CPU_STACK_SIZE) : NULL;
+        if (cpu == NULL) {
+            print_log(strlit("smp: leaving lapic "));
+            print_log_u64(info->lapic_id);
+            print_log(strlit(" offline, out of memory or MAX_CPUS reached\n"));
+            if (stack != 0) {
+                pmm_free_pages(stack, CPU_STACK_SIZE / PAGE_SIZE);
+            }
+            continue;
+        }
+
+        trace_init_cpu(cpu);
+        timer_init_cpu(cpu);
+        info->extra_argument = (u64)cpu;
+        expected++;
+    }
+
+    for (u64 i = 0; i < mp->cpu_count; i++) {
+        struct limine_mp_info* info = mp->cpus[i];
+        if (info->extra_argument != 0 && info->lapic_id != mp->bsp_lapic_id) {
+            __atomic_store_n(&info->goto_address, ap_entry, __ATOMIC_RELEASE);
+        }
+    }
+
+    // Without a calibrated TSC assume a few GHz, this is only a bound.
+    u64 start   = tsc_read();
+    u64 timeout = tsc_frequency() != 0 ? tsc_frequency() / 1000 * SMP_STARTUP_TIMEOUT_MS : 1ull << 32;
+    while (smp_online_count() < expected && tsc_read() - start < timeout) {
+        cpu_pause();
+    }
+
+    print_log(strlit("smp: "));
+    print_log_u64(smp_online_count());
+    print_log(strlit(" of "));
+    print_log_u64(mp->cpu_count);
+    print_log(strlit(" CPUs online\n"));
+}
+
+u32 smp_online_count(void) {
+    return __atomic_load_n(&online_count, __ATOMIC_ACQUIRE);
+}
+
+// Flushes the TLB of every other online CPU and waits until they all have.
+// The caller must have interrupts enabled and hold no spinlock a target CPU
+// might be spinning on with interrupts off, otherwise the IPI can never be
+// taken. Waiting on shootdown_lock with interrupts on is what lets two
+// concurrent shootdowns answer each other.
+void smp_tlb_shootdown(void) {
+    if (smp_online_count() <= 1) {
+        return;
+    }
+
+    spin_lock(&shootdown_lock);
+    TRACE(TLB_SHOOTDOWN, smp_online_count() - 1);
+
+    PerCpu* self = this_cpu();
+    for (u32 i = 0; i < percpu_count(); i++) {
+        PerCpu* cpu = percpu_get(i);
+        if (cpu == self || !__atomic_load_n(&cpu->online, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        __atomic_add_fetch(&shootdown_pending, 1, __ATOMIC_ACQUIRE);
+        lapic_send_ipi(cpu->lapic_id, VECTOR_IPI_TLB_SHOOTDOWN);
+    }
+
+    while (__atomic_load_n(&shootdown_pending, __ATOMIC_ACQUIRE) != 0) {
+        cpu_pause();
+    }
+
+    spin_unlock(&shootdown_lock);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Brings up the application processors through the Limine MP request. Each
+// AP switches to its own stack, loads the kernel page tables, a GDT/TSS of
+// its own and the shared IDT, then becomes that CPU's idle thread.
+
+struct limine_mp_response;
+
+#define SMP_STARTUP_TIMEOUT_MS 1000
+
+void smp_init(struct limine_mp_response* mp);
+u32  smp_online_count(void);
+void smp_tlb_shootdown(void);
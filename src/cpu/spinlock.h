@@ -0,0 +1,140 @@
+#pragma once
+
+// Spinlocks, with the atomics written out as x86 instructions.
+//
+// Spinlock is a ticket lock: a locked xadd draws a ticket and the lock is
+// handed over in ticket order, so no waiter starves. All waiters spin on
+// the one cache line, which every unlock invalidates in each of their
+// caches. McsLock queues waiters instead, each spinning on its own McsNode
+// (usually on its stack), and the unlock writes only the next waiter's
+// line. It suits locks that see real contention.
+//
+// Use the _irqsave variants for any lock an interrupt handler can also
+// take, otherwise the handler can spin forever on a lock its own CPU holds.
+// Needs cpu/cpu.h.
+
+#define SPINLOCK_TICKET 0x10000 // One step of `next`
+
+typedef union {
+    volatile u32 tickets;
+    struct {
+        volatile u16 owner; // Ticket being served
+        volatile u16 next;  // Ticket the next caller draws
+    };
+} Spinlock;
+
+typedef struct McsNode {
+    struct McsNode* volatile next;
+    volatile u32             locked;
+} McsNode;
+
+typedef struct {
+    McsNode* volatile tail; // Last waiter, NULL when free
+} McsLock;
+
+static inline bool spin_try_lock(Spinlock* lock) {
+    u32 old = lock->tickets;
+    if ((u16)old != (u16)(old >> 16)) {
+        return false;
+    }
+
+    u32 seen = old;
+    asm volatile (
+            "lock cmpxchg %0, %2"
+            : "+m" (lock->tickets), "+a" (seen)
+            : "r" (old + SPINLOCK_TICKET)
+            : "memory"
+    );
+    return seen == old;
+}
+
+static inline void spin_lock(Spinlock* lock) {
+    u32 tickets = SPINLOCK_TICKET;
+    asm volatile (
+            "lock xadd %0, %1"
+            : "+m" (lock->tickets), "+r" (tickets)
+            :
+            : "memory"
+    );
+
+    u16 ticket = tickets >> 16;
+    while (lock->owner != ticket) {
+        cpu_pause();
+    }
+    asm volatile ("" ::: "memory");
+}
+
+// Only the holder writes `owner`, so the increment needs no lock prefix.
+// Stores are not reordered with earlier loads or stores on x86.
+static inline void spin_unlock(Spinlock* lock) {
+    asm volatile ("add %0, 1" : "+m" (lock->owner) : : "memory");
+}
+
+static inline u64 spin_lock_irqsave(Spinlock* lock) {
+    u64 flags = interrupts_save();
+    spin_lock(lock);
+    return flags;
+}
+
+static inline void spin_unlock_irqrestore(Spinlock* lock, u64 flags) {
+    spin_unlock(lock);
+    interrupts_restore(flags);
+}
+
+// The node must stay put until the matching mcs_unlock().
+static inline void mcs_lock(McsLock* lock, McsNode* node) {
+    node->next   = NULL;
+    node->locked = 1;
+
+    McsNode* previous = node;
+    asm volatile (
+            "xchg %0, %1"
+            : "+m" (lock->tail), "+r" (previous)
+            :
+            : "memory"
+    );
+
+    if (previous != NULL) {
+        previous->next = node;
+        while (node->locked) {
+            cpu_pause();
+        }
+    }
+    asm volatile ("" ::: "memory");
+}
+
+// With no successor queued the tail is swung back to NULL. If that fails
+// one is in the middle of linking itself in, wait for it.
+static inline void mcs_unlock(McsLock* lock, McsNode* node) {
+    asm volatile ("" ::: "memory");
+
+    if (node->next == NULL) {
+        McsNode* tail = node;
+        asm volatile (
+                "lock cmpxchg %0, %2"
+                : "+m" (lock->tail), "+a" (tail)
+                : "r" ((McsNode*)NULL)
+                : "memory"
+        );
+        if (tail == node) {
+            return;
+        }
+
+        while (node->next == NULL) {
+            cpu_pause();
+        }
+    }
+
+    node->next->locked = 0;
+}
+
+static inline u64 mcs_lock_irqsave(McsLock* lock, McsNode* node) {
+    u64 flags = interrupts_save();
+    mcs_lock(lock, node);
+    return flags;
+}
+
+static inline void mcs_unlock_irqrestore(McsLock* lock, McsNode* node, u64 flags) {
+    mcs_unlock(lock, node);
+    interrupts_restore(flags);
+}
@@ -0,0 +1,121 @@
+#include <util.h>
+#include <string.h>
+#include "acpi/acpi.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "drivers/serial.h"
+#include "ioapic.h"
+
+#define IOAPIC_REGSEL 0x00
+#define IOAPIC_WINDOW 0x10
+
+#define IOAPIC_REG_VERSION     0x01
+#define IOAPIC_REG_REDIRECTION 0x10 // Two registers per input
+
+#define REDIRECT_ACTIVE_LOW (1 << 13)
+#define REDIRECT_LEVEL      (1 << 15)
+#define REDIRECT_MASKED     (1 << 16)
+
+typedef struct {
+    volatile u32* base;
+    u32           gsi_base;
+    u32           inputs;
+} IoApic;
+
+static IoApic ioapics[ACPI_MAX_IOAPICS];
+static u32    ioapic_count;
+
+// Register access goes through an index/data pair. Callers serialise,
+// see irq.c.
+static u32 ioapic_read(IoApic* ioapic, u32 reg) {
+    ioapic->base[IOAPIC_REGSEL / 4] = reg;
+    return ioapic->base[IOAPIC_WINDOW / 4];
+}
+
+static void ioapic_write(IoApic* ioapic, u32 reg, u32 value) {
+    ioapic->base[IOAPIC_REGSEL / 4] = reg;
+    ioapic->base[IOAPIC_WINDOW / 4] = value;
+}
+
+static IoApic* ioapic_for(u32 gsi) {
+    for (u32 i = 0; i < ioapic_count; i++) {
+        if (gsi >= ioapics[i].gsi_base && gsi < ioapics[i].gsi_base + ioapics[i].inputs) {
+            return &ioapics[i];
+        }
+    }
+
+    return NULL;
+}
+
+bool ioapic_init(const AcpiMadt* madt) {
+    if (madt == NULL) {
+        return false;
+    }
+
+    for (u32 i = 0; i < madt->ioapic_count; i++) {
+        u64 phys = madt->ioapics[i].address;
+        if (!vmm_map((u64)phys_to_virt(phys), phys, 1, VMM_FLAG_WRITE | VMM_FLAG_UNCACHED, NULL)) {
+            print_log(strlit("ioapic: out of memory mapping the registers\n"));
+            continue;
+        }
+
+        IoApic* ioapic = &ioapics[ioapic_count++];
+        ioapic->base     = phys_to_virt(phys);
+        ioapic->gsi_base = madt->ioapics[i].gsi_base;
+        ioapic->inputs   = ((ioapic_read(ioapic, IOAPIC_REG_VERSION) >> 16) & 0xFF) + 1;
+
+        for (u32 input = 0; input < ioapic->inputs; input++) {
+            ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2, REDIRECT_MASKED);
+            ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2 + 1, 0);
+        }
+    }
+
+    return ioapic_count > 0;
+}
+
+u32 ioapic_gsi_count(void) {
+    u32 highest = 0;
+    for (u32 i = 0; i < ioapic_count; i++) {
+        if (ioapics[i].gsi_base + ioapics[i].inputs > highest) {
+            highest = ioapics[i].gsi_base + ioapics[i].inputs;
+        }
+    }
+
+    return highest;
+}
+
+// Fixed delivery to one CPU by physical APIC id, unmasked. The destination
+// field is 8 bits, larger ids would need interrupt remapping.
+bool ioapic_route(u32 gsi, u8 vector, u32 lapic_id, u16 inti_flags) {
+    IoApic* ioapic = ioapic_for(gsi);
+    if (ioapic == NULL || lapic_id > 0xFF) {
+        return false;
+    }
+
+    u32 low = vector;
+    if ((inti_flags & ACPI_INTI_POLARITY_MASK) == ACPI_INTI_POLARITY_LOW) {
+        low |= REDIRECT_ACTIVE_LOW;
+    }
+
+    if ((inti_flags & ACPI_INTI_TRIGGER_MASK) == ACPI_INTI_TRIGGER_LEVEL) {
+        low |= REDIRECT_LEVEL;
+    }
+
+    u32 input = gsi - ioapic->gsi_base;
+    // Mask while the destination changes so the entry is never half written.
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2, REDIRECT_MASKED);
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2 + 1, lapic_id << 24);
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2, low);
+    return true;
+}
+
+void ioapic_mask(u32 gsi) {
+    IoApic* ioapic = ioapic_for(gsi);
+    if (ioapic == NULL) {
+        return;
+    }
+
+    u32 input = gsi - ioapic->gsi_base;
+    u32 low   = ioapic_read(ioapic, IOAPIC_REG_REDIRECTION + input*2);
+    ioapic_write(ioapic, IOAPIC_REG_REDIRECTION + input*2, low | REDIRECT_MASKED);
+}
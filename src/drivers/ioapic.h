@@ -0,0 +1,12 @@
+#pragma once
+
+// I/O APICs found in the MADT. Each one takes a range of global system
+// interrupts (GSIs) and turns them into fixed interrupts for one local
+// APIC. Every input starts masked. Needs acpi/acpi.h.
+
+#define IOAPIC_MAX_INPUTS 240
+
+bool ioapic_init(const AcpiMadt* madt);
+u32  ioapic_gsi_count(void);
+bool ioapic_route(u32 gsi, u8 vector, u32 lapic_id, u16 inti_flags);
+void ioapic_mask(u32 gsi);
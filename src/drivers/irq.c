@@ -0,0 +1,175 @@
+#include <util.h>
+#include <string.h>
+#include "acpi/acpi.h"
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "serial.h"
+#include "pic.h"
+#include "lapic.h"
+#include "ioapic.h"
+#include "irq.h"
+
+typedef struct {
+    InterruptHandler handler;
+    u32              cpu_id;   // Where it is delivered now
+    bool             balanced; // Registered with IRQ_ANY_CPU
+} IrqLine;
+
+static const AcpiMadt* madt;
+static bool            use_ioapic;
+static IrqLine         lines[IRQ_LINES];
+static Spinlock        irq_lock; // Routing table and the I/O APIC index register
+
+// Takes over from the PIC when there is an I/O APIC. pic_init() has already
+// moved the PIC off the exception vectors, masking the cascade as well
+// leaves it completely silent.
+void irq_init(const AcpiMadt* table) {
+    madt = table;
+    use_ioapic = ioapic_init(table);
+
+    // smp_init() fills this in for the BSP, routing needs it before then.
+    this_cpu()->lapic_id = lapic_id();
+
+    if (use_ioapic) {
+        pic_mask(PIC_IRQ_CASCADE);
+        print_log(strlit("irq: routing through "));
+        print_log_u64(madt->ioapic_count);
+        print_log(strlit(" I/O APIC(s), "));
+        print_log_u64(ioapic_gsi_count());
+        print_log(strlit(" inputs\n"));
+    }
+    else {
+        print_log(strlit("irq: no I/O APIC, using the 8259 PIC on the BSP\n"));
+    }
+}
+
+// Points the line at a CPU, irq_lock held. The PIC can only reach the BSP,
+// there the line is just unmasked.
+static bool route(u8 irq, u32 cpu_id) {
+    if (!use_ioapic) {
+        pic_unmask(irq);
+        lines[irq].cpu_id = 0;
+        return true;
+    }
+
+    if (cpu_id >= percpu_count() || !percpu_get(cpu_id)->online) {
+        return false;
+    }
+
+    PerCpu* cpu = percpu_get(cpu_id);
+
+    AcpiIsaIrq isa = madt->isa_irqs[irq];
+    if (!ioapic_route(isa.gsi, VECTOR_IRQ_BASE + irq, cpu->lapic_id, isa.flags)) {
+        return false;
+    }
+
+    lines[irq].cpu_id = cpu_id;
+    return true;
+}
+
+// Installs the handler and unmasks the line on the given CPU. IRQ_ANY_CPU
+// starts on the BSP and is spread out by irq_balance() once the APs are up.
+bool irq_register(u8 irq, InterruptHandler handler, u32 cpu_id) {
+    if (irq >= IRQ_LINES || irq == PIC_IRQ_CASCADE) {
+        return false;
+    }
+
+    interrupt_register(VECTOR_IRQ_BASE + irq, handler);
+
+    u64 flags = spin_lock_irqsave(&irq_lock);
+    lines[irq].handler  = handler;
+    lines[irq].balanced = cpu_id == IRQ_ANY_CPU;
+    bool routed = route(irq, cpu_id == IRQ_ANY_CPU ? 0 : cpu_id);
+    spin_unlock_irqrestore(&irq_lock, flags);
+
+    return routed;
+}
+
+// Moves a registered line. An interrupt already in flight may still arrive
+// on the old CPU, handlers must not care which CPU they run on.
+bool irq_set_affinity(u8 irq, u32 cpu_id) {
+    if (irq >= IRQ_LINES || cpu_id == IRQ_ANY_CPU) {
+        return false;
+    }
+
+    u64 flags = spin_lock_irqsave(&irq_lock);
+    bool routed = lines[irq].handler != NULL && route(irq, cpu_id);
+    if (routed) {
+        lines[irq].balanced = false;
+    }
+    spin_unlock_irqrestore(&irq_lock, flags);
+
+    return routed;
+}
+
+// Deals the IRQ_ANY_CPU lines out round robin over the online CPUs,
+// starting after the BSP, which already takes the boot work.
+void irq_balance(void) {
+    if (!use_ioapic) {
+        return;
+    }
+
+    u32 count = percpu_count();
+    u32 next  = 1;
+
+    u64 flags = spin_lock_irqsave(&irq_lock);
+    for (u8 irq = 0; irq < IRQ_LINES; irq++) {
+        if (lines[irq].handler == NULL || !lines[irq].balanced) {
+            continue;
+        }
+
+        for (u32 tries = 0; tries < count; tries++) {
+            u32 cpu_id = next++ % count;
+            if (route(irq, cpu_id)) {
+                break;
+            }
+        }
+    }
+    spin_unlock_irqrestore(&irq_lock, flags);
+}
+
+void irq_eoi(u8 irq) {
+    if (use_ioapic) {
+        lapic_eoi();
+    }
+    else {
+        pic_eoi(irq);
+    }
+}
+
+// Address and data for a PCI MSI capability so the device interrupts the
+// given CPU: fixed delivery, edge triggered, physical destination.
+bool irq_msi_message(u32 cpu_id, u8 vector, u64* address, u32* data) {
+    if (cpu_id >= percpu_count() || percpu_get(cpu_id)->lapic_id > 0xFF) {
+        return false;
+    }
+
+    PerCpu* cpu = percpu_get(cpu_id);
+
+    *address = IRQ_MSI_ADDRESS_BASE | ((u64)cpu->lapic_id << 12);
+    *data    = vector;
+    return true;
+}
+
+void irq_print_routes(void) {
+    for (u8 irq = 0; irq < IRQ_LINES; irq++) {
+        if (lines[irq].handler == NULL) {
+            continue;
+        }
+
+        print_log(strlit("irq: line "));
+        print_log_u64(irq);
+        if (use_ioapic) {
+            print_log(strlit(" (gsi "));
+            print_log_u64(madt->isa_irqs[irq].gsi);
+            print_log(strlit(")"));
+        }
+        print_log(strlit(" -> cpu "));
+        print_log_u64(lines[irq].cpu_id);
+        print_log(lines[irq].balanced ? strlit(", balanced\n") : strlit("\n"));
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Device interrupt routing. ISA lines go through the I/O APIC when the MADT
+// has one, each delivered to the local APIC of a chosen CPU, otherwise
+// through the 8259 PIC to the BSP. Line n always lands on vector
+// VECTOR_IRQ_BASE + n. Handlers run on whichever CPU the line points at and
+// finish with irq_eoi(). Needs acpi/acpi.h and cpu/idt.h.
+
+#define IRQ_TIMER    0
+#define IRQ_KEYBOARD 1
+#define IRQ_COM1     4
+#define IRQ_LINES    16
+
+#define IRQ_ANY_CPU 0xFFFFFFFF // Let irq_balance() pick
+
+// MSI messages target the local APIC window directly.
+#define IRQ_MSI_ADDRESS_BASE 0xFEE00000
+
+void irq_init(const AcpiMadt* madt);
+bool irq_register(u8 irq, InterruptHandler handler, u32 cpu_id);
+bool irq_set_affinity(u8 irq, u32 cpu_id);
+void irq_balance(void);
+void irq_eoi(u8 irq);
+bool irq_msi_message(u32 cpu_id, u8 vector, u64* address, u32* data);
+void irq_print_routes(void);
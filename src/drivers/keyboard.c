@@ -0,0 +1,58 @@
+#include <util.h>
+#include <string.h>
+#include "acpi/acpi.h"
+#include "cpu/cpu.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "serial.h"
+#include "irq.h"
+#include "keyboard.h"
+
+#define I8042_DATA   0x60
+#define I8042_STATUS 0x64
+
+#define STATUS_OUTPUT_FULL (1 << 0)
+
+// The interrupt is the only producer, keyboard_read() callers are
+// serialised by keyboard_lock so the ring can be read from any CPU.
+static u8       scancodes[KEYBOARD_RING_SIZE];
+static u32      head;
+static u32      tail;
+static Spinlock keyboard_lock;
+
+static void keyboard_interrupt(InterruptFrame* frame) {
+    spin_lock(&keyboard_lock);
+    while (inb(I8042_STATUS) & STATUS_OUTPUT_FULL) {
+        u8 scancode = inb(I8042_DATA);
+        // Drop keys when nobody reads them rather than overwrite.
+        if (head - tail < KEYBOARD_RING_SIZE) {
+            scancodes[head++ % KEYBOARD_RING_SIZE] = scancode;
+        }
+    }
+    spin_unlock(&keyboard_lock);
+
+    irq_eoi(IRQ_KEYBOARD);
+}
+
+void keyboard_init(void) {
+    // Whatever the firmware left in the output buffer would otherwise keep
+    // the edge-triggered line from ever firing.
+    while (inb(I8042_STATUS) & STATUS_OUTPUT_FULL) {
+        inb(I8042_DATA);
+    }
+
+    if (!irq_register(IRQ_KEYBOARD, keyboard_interrupt, IRQ_ANY_CPU)) {
+        print_log(strlit("keyboard: couldn't route the interrupt\n"));
+    }
+}
+
+bool keyboard_read(u8* scancode) {
+    u64 flags = spin_lock_irqsave(&keyboard_lock);
+    bool available = head != tail;
+    if (available) {
+        *scancode = scancodes[tail++ % KEYBOARD_RING_SIZE];
+    }
+    spin_unlock_irqrestore(&keyboard_lock, flags);
+
+    return available;
+}
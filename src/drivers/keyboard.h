@@ -0,0 +1,9 @@
+#pragma once
+
+// PS/2 keyboard on the legacy i8042 controller. The interrupt handler only
+// moves raw set 1 scancodes into a ring, decoding is left to the reader.
+
+#define KEYBOARD_RING_SIZE 256
+
+void keyboard_init(void);
+bool keyboard_read(u8* scancode);
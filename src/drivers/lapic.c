@@ -0,0 +1,170 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "time/tsc.h"
+#include "panic.h"
+#include "lapic.h"
+
+#define MSR_APIC_BASE        0x1B
+#define APIC_BASE_ENABLE     (1 << 11)
+#define APIC_BASE_X2APIC     (1 << 10)
+#define APIC_BASE_ADDRESS    0xFFFFFF000ull
+#define MSR_X2APIC_BASE      0x800 // Register offset / 16 is added to this
+#define MSR_TSC_DEADLINE     0x6E0
+
+#define LAPIC_ID             0x020
+#define LAPIC_TPR            0x080
+#define LAPIC_EOI            0x0B0
+#define LAPIC_SVR            0x0F0
+#define LAPIC_ICR_LOW        0x300
+#define LAPIC_ICR_HIGH       0x310
+#define LAPIC_LVT_TIMER      0x320
+#define LAPIC_TIMER_INITIAL  0x380
+#define LAPIC_TIMER_CURRENT  0x390
+#define LAPIC_TIMER_DIVIDE   0x3E0
+
+#define SVR_ENABLE           (1 << 8)
+#define ICR_DELIVERY_PENDING (1 << 12)
+#define ICR_LEVEL_ASSERT     (1 << 14)
+#define LVT_MASKED           (1 << 16)
+#define LVT_TIMER_DEADLINE   (2 << 17)
+#define TIMER_DIVIDE_BY_16   0x3
+
+#define LAPIC_CALIBRATION_MS 10
+#define LAPIC_ONESHOT_MAX_MS 1000 // Longer waits are split, see lapic_timer_oneshot()
+
+static volatile u32* lapic_base;
+static bool          x2apic;
+static bool          tsc_deadline;
+static u64           timer_frequency; // Timer ticks per second at divide by 16
+
+static u32 lapic_read(u32 reg) {
+    if (x2apic) {
+        return (u32)rdmsr(MSR_X2APIC_BASE + reg / 16);
+    }
+
+    return lapic_base[reg / 4];
+}
+
+static void lapic_write(u32 reg, u32 value) {
+    if (x2apic) {
+        wrmsr(MSR_X2APIC_BASE + reg / 16, value);
+        return;
+    }
+
+    lapic_base[reg / 4] = value;
+}
+
+// Finds the register window and maps it uncached. The HHDM only covers RAM,
+// so the MMIO page is mapped at its HHDM address by hand.
+void lapic_init(void) {
+    u64 base = rdmsr(MSR_APIC_BASE);
+    x2apic = (base & APIC_BASE_X2APIC) != 0;
+    tsc_deadline = (cpuid(1, 0).ecx & CPUID_1_ECX_TSC_DEADLINE) != 0;
+
+    if (!x2apic) {
+        u64 phys = base & APIC_BASE_ADDRESS;
+        if (!vmm_map((u64)phys_to_virt(phys), phys, 1, VMM_FLAG_WRITE | VMM_FLAG_UNCACHED, NULL)) {
+            panic(strlit("lapic: out of memory mapping the registers"));
+        }
+
+        lapic_base = phys_to_virt(phys);
+    }
+
+    lapic_init_cpu();
+}
+
+void lapic_init_cpu(void) {
+    wrmsr(MSR_APIC_BASE, rdmsr(MSR_APIC_BASE) | APIC_BASE_ENABLE);
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+}
+
+u32 lapic_id(void) {
+    u32 id = lapic_read(LAPIC_ID);
+    return x2apic ? id : id >> 24;
+}
+
+void lapic_eoi(void) {
+    lapic_write(LAPIC_EOI, 0);
+}
+
+// Fixed delivery, physical destination.
+void lapic_send_ipi(u32 target, u8 vector) {
+    if (x2apic) {
+        wrmsr(MSR_X2APIC_BASE + LAPIC_ICR_LOW / 16, ((u64)target << 32) | ICR_LEVEL_ASSERT | vector);
+        return;
+    }
+
+    u64 flags = interrupts_save();
+    while (lapic_read(LAPIC_ICR_LOW) & ICR_DELIVERY_PENDING) {
+        cpu_pause();
+    }
+
+    lapic_write(LAPIC_ICR_HIGH, target << 24);
+    lapic_write(LAPIC_ICR_LOW, ICR_LEVEL_ASSERT | vector);
+    interrupts_restore(flags);
+}
+
+// Counts how far the timer runs down in a few milliseconds of TSC time. The
+// timer clock is the same on every CPU, so this only runs once.
+void lapic_timer_calibrate(void) {
+    lapic_write(LAPIC_TIMER_DIVIDE, TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED);
+
+    u64 wait = tsc_frequency() / 1000 * LAPIC_CALIBRATION_MS;
+    lapic_write(LAPIC_TIMER_INITIAL, 0xFFFFFFFF);
+    u64 start = tsc_read();
+    while (tsc_read() - start < wait) {
+        cpu_pause();
+    }
+
+    u32 elapsed = 0xFFFFFFFF - lapic_read(LAPIC_TIMER_CURRENT);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+
+    timer_frequency = (u64)elapsed * 1000 / LAPIC_CALIBRATION_MS;
+    if (timer_frequency == 0) {
+        panic(strlit("lapic: timer calibration failed"));
+    }
+}
+
+bool lapic_timer_has_deadline(void) {
+    return tsc_deadline;
+}
+
+// Fires `vector` once, when the TSC reaches `deadline`. In TSC-deadline mode
+// that is exact. Otherwise the count-down timer approximates it from the
+// calibration and is capped at LAPIC_ONESHOT_MAX_MS, so a far deadline
+// costs a wakeup now and then and the caller just programs it again.
+void lapic_timer_oneshot(u8 vector, u64 deadline) {
+    if (tsc_deadline) {
+        lapic_write(LAPIC_LVT_TIMER, LVT_TIMER_DEADLINE | vector);
+        // The LVT write has to land before the MSR write arms the timer.
+        asm volatile ("mfence" ::: "memory");
+        wrmsr(MSR_TSC_DEADLINE, deadline);
+        return;
+    }
+
+    u64 now   = tsc_read();
+    u64 delta = deadline > now ? deadline - now : 0;
+    u64 limit = tsc_frequency() / 1000 * LAPIC_ONESHOT_MAX_MS;
+    if (delta > limit) {
+        delta = limit;
+    }
+
+    u64 count = delta * timer_frequency / tsc_frequency();
+    lapic_write(LAPIC_TIMER_DIVIDE, TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_LVT_TIMER, vector);
+    lapic_write(LAPIC_TIMER_INITIAL, count == 0 ? 1 : (u32)count);
+}
+
+void lapic_timer_stop(void) {
+    if (tsc_deadline) {
+        wrmsr(MSR_TSC_DEADLINE, 0);
+    }
+
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Local APIC of the calling CPU, in xAPIC (MMIO) or x2APIC (MSR) mode,
+// whichever the firmware left it in. Only what SMP and the timer wheel
+// need: enabling it, EOI, inter-processor interrupts and a one-shot timer
+// that takes a TSC deadline.
+
+#define LAPIC_SPURIOUS_VECTOR 0xFF
+
+void lapic_init(void);
+void lapic_init_cpu(void);
+u32  lapic_id(void);
+void lapic_eoi(void);
+void lapic_send_ipi(u32 lapic_id, u8 vector);
+void lapic_timer_calibrate(void);
+bool lapic_timer_has_deadline(void);
+void lapic_timer_oneshot(u8 vector, u64 deadline);
+void lapic_timer_stop(void);
@@ -0,0 +1,59 @@
+#include <util.h>
+#include <string.h>
+#include "serial.h"
+#include "cpu/idt.h"
+#include "pic.h"
+
+#define PIC1_COMMAND 0x20
+#define PIC1_DATA    0x21
+#define PIC2_COMMAND 0xA0
+#define PIC2_DATA    0xA1
+
+#define PIC_EOI 0x20
+
+// Port 0x80 is unused, writing to it gives the PIC time to settle between
+// initialisation words on old hardware.
+static void io_wait(void) {
+    outb(0x80, 0);
+}
+
+void pic_init(void) {
+    outb(PIC1_COMMAND, 0x11);            // ICW1: initialise, expect ICW4
+    io_wait();
+    outb(PIC2_COMMAND, 0x11);
+    io_wait();
+    outb(PIC1_DATA, VECTOR_IRQ_BASE);     // ICW2: vector offsets
+    io_wait();
+    outb(PIC2_DATA, VECTOR_IRQ_BASE + 8);
+    io_wait();
+    outb(PIC1_DATA, 1 << PIC_IRQ_CASCADE); // ICW3: slave on IRQ 2
+    io_wait();
+    outb(PIC2_DATA, PIC_IRQ_CASCADE);
+    io_wait();
+    outb(PIC1_DATA, 0x01);               // ICW4: 8086 mode
+    io_wait();
+    outb(PIC2_DATA, 0x01);
+    io_wait();
+
+    // Everything masked except the cascade line.
+    outb(PIC1_DATA, (u8)~(1 << PIC_IRQ_CASCADE));
+    outb(PIC2_DATA, 0xFF);
+}
+
+void pic_mask(u8 irq) {
+    u16 port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) | (1 << (irq % 8)));
+}
+
+void pic_unmask(u8 irq) {
+    u16 port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) & ~(1 << (irq % 8)));
+}
+
+void pic_eoi(u8 irq) {
+    if (irq >= 8) {
+        outb(PIC2_COMMAND, PIC_EOI);
+    }
+
+    outb(PIC1_COMMAND, PIC_EOI);
+}
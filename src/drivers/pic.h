@@ -0,0 +1,15 @@
+#pragma once
+
+// Legacy 8259 PIC pair, remapped so IRQ 0-15 land on vectors 0x20-0x2F.
+// Every line starts masked. Drivers go through irq.h, which only falls
+// back to the PIC when there is no I/O APIC.
+
+#define PIC_IRQ_TIMER    0
+#define PIC_IRQ_KEYBOARD 1
+#define PIC_IRQ_CASCADE  2
+#define PIC_IRQ_COM1     4
+
+void pic_init(void);
+void pic_mask(u8 irq);
+void pic_unmask(u8 irq);
+void pic_eoi(u8 irq);
@@ -1,7 +1,51 @@
 #include <util.h>
 #include <string.h>
+#include "acpi/acpi.h"
+#include "cpu/cpu.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "mem.h"
+#include "irq.h"
 #include "serial.h"
 
+#define UART_IER 1
+#define UART_IIR 2
+#define UART_LSR 5
+
+#define IER_THR_EMPTY  (1 << 1)
+#define IIR_ID_MASK    0x0E
+#define IIR_THR_EMPTY  0x02
+#define LSR_THR_EMPTY  (1 << 5)
+#define LSR_TX_IDLE    (1 << 6)
+
+// The 16550 transmit FIFO holds 16 bytes, one THRE interrupt refills it.
+#define UART_FIFO_SIZE   16
+#define SERIAL_RING_SIZE KB(16)
+
+// Transmit ring, any number of producers and one consumer, with no lock on
+// the producer side. A producer claims space by moving tx_reserved with a
+// cmpxchg, copies its bytes in and publishes them by moving tx_head, in
+// the order the space was claimed. Interrupts are off from claim to
+// publish, so nothing later waits on a producer that was preempted or
+// interrupted. The consumer side (the THRE interrupt, a print restarting an
+// idle transmitter, polled draining) only moves tx_tail and is serialised
+// by tx_lock, which is never held while waiting on the UART. The counters
+// run freely and are reduced modulo the ring size on access.
+static u8 tx_ring[SERIAL_RING_SIZE];
+static u64 tx_reserved;
+static u64 tx_head;
+static u64 tx_tail;
+static u64 tx_dropped; // Bytes print_log() found no room for
+static volatile bool tx_busy; // A THRE interrupt will follow up on the FIFO
+static volatile bool tx_exclusive; // A serial_write() owns the ring
+static volatile bool irq_enabled;
+static Spinlock tx_lock;
+
+// Gets a copy of everything passed to print_log(), the framebuffer console
+// hooks in here. Called with no lock held, from any CPU, the mirror does its
+// own locking.
+static LogMirror log_mirror;
+
 void outb(u16 port, u8 value) {
     asm (
             "out %0, %1"
@@ -41,8 +85,253 @@ int serial_init() {
    return 0;
 }
 
+static void fill_fifo(void) {
+    u64 head = __atomic_load_n(&tx_head, __ATOMIC_ACQUIRE);
+    u64 tail = tx_tail;
+    u32 count = 0;
+
+    while (count < UART_FIFO_SIZE && tail != head) {
+        outb(PORT, tx_ring[tail % SERIAL_RING_SIZE]);
+        tail++;
+        count++;
+    }
+
+    __atomic_store_n(&tx_tail, tail, __ATOMIC_RELEASE);
+    tx_busy = count != 0;
+}
+
+// Waits for the FIFO with tx_lock released, only the refill takes it.
+static void drain_polled(bool drain_all) {
+    while (__atomic_load_n(&tx_tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&tx_head, __ATOMIC_ACQUIRE)) {
+        while (!(inb(PORT + UART_LSR) & LSR_THR_EMPTY)) {
+            cpu_pause();
+        }
+
+        u64 flags = spin_lock_irqsave(&tx_lock);
+        if (inb(PORT + UART_LSR) & LSR_THR_EMPTY) {
+            fill_fifo();
+        }
+        spin_unlock_irqrestore(&tx_lock, flags);
+
+        if (!drain_all) {
+            break;
+        }
+    }
+}
+
+static void serial_interrupt(InterruptFrame* frame) {
+    spin_lock(&tx_lock);
+    if ((inb(PORT + UART_IIR) & IIR_ID_MASK) == IIR_THR_EMPTY) {
+        fill_fifo();
+    }
+    spin_unlock(&tx_lock);
+
+    irq_eoi(IRQ_COM1);
+}
+
+// Gets bytes moving after a print. Until serial_enable_interrupts() this
+// is the old synchronous path, afterwards it only primes an idle FIFO and
+// the THRE interrupt does the rest.
+static void kick(void) {
+    if (!irq_enabled) {
+        drain_polled(true);
+        return;
+    }
+
+    u64 flags = spin_lock_irqsave(&tx_lock);
+    if (!tx_busy && (inb(PORT + UART_LSR) & LSR_THR_EMPTY)) {
+        fill_fifo();
+    }
+    spin_unlock_irqrestore(&tx_lock, flags);
+}
+
+// The line may land on any CPU, irq_balance() moves it off the BSP.
+void serial_enable_interrupts(void) {
+    if (!irq_register(IRQ_COM1, serial_interrupt, IRQ_ANY_CPU)) {
+        print_log(strlit("serial: no interrupt, staying polled\n"));
+        return;
+    }
+
+    u64 flags = interrupts_save();
+    irq_enabled = true;
+    tx_busy = false;
+    outb(PORT + UART_IER, IER_THR_EMPTY);
+    interrupts_restore(flags);
+
+    kick();
+}
+
+// Back to draining by polling for good, so a panic with interrupts off
+// still gets every line out instead of dropping them.
+void serial_force_polled(void) {
+    irq_enabled = false;
+}
+
+// Synchronously pushes out everything still queued, for the panic path and
+// anything else that is about to stop taking interrupts.
+void serial_flush(void) {
+    drain_polled(true);
+    while (!(inb(PORT + UART_LSR) & LSR_TX_IDLE)) {
+        cpu_pause();
+    }
+}
+
+void serial_set_log_mirror(LogMirror mirror) {
+    log_mirror = mirror;
+}
+
+// Claims `size` bytes of the ring. Fails if they aren't free, or if a
+// serial_write() owns the ring and this isn't it. Interrupts must be off.
+static bool ring_reserve(u64 size, bool exclusive, u64* start) {
+    u64 reserved = __atomic_load_n(&tx_reserved, __ATOMIC_RELAXED);
+    do {
+        if (tx_exclusive && !exclusive) {
+            return false;
+        }
+
+        if (reserved + size - __atomic_load_n(&tx_tail, __ATOMIC_ACQUIRE) > SERIAL_RING_SIZE) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&tx_reserved, &reserved, reserved + size, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    *start = reserved;
+    return true;
+}
+
+// Copies into claimed space, in at most two pieces, the second one after
+// wrapping around, and publishes it once every earlier claim is.
+static void ring_commit(const u8* data, u64 start, u64 size) {
+    u64 offset = start % SERIAL_RING_SIZE;
+    u64 first  = SERIAL_RING_SIZE - offset;
+    if (first > size) {
+        first = size;
+    }
+
+    memcpy(tx_ring + offset, data, first);
+    memcpy(tx_ring, data + first, size - first);
+
+    while (__atomic_load_n(&tx_head, __ATOMIC_ACQUIRE) != start) {
+        cpu_pause();
+    }
+    __atomic_store_n(&tx_head, start + size, __ATOMIC_RELEASE);
+}
+
+// Writes `size` bytes, no more than SERIAL_RING_SIZE, as one piece. With
+// the ring full it waits for the THRE interrupt if interrupts are enabled,
+// drains by polling before serial_enable_interrupts() or for the exclusive
+// writer, and otherwise gives up and returns false, having written nothing.
+static bool ring_write(const u8* data, u64 size, bool exclusive) {
+    for (;;) {
+        u64 start;
+        u64 flags = interrupts_save();
+        if (ring_reserve(size, exclusive, &start)) {
+            ring_commit(data, start, size);
+            interrupts_restore(flags);
+            kick();
+            return true;
+        }
+        interrupts_restore(flags);
+
+        if (irq_enabled && (flags & RFLAGS_IF)) {
+            kick();
+            cpu_pause();
+        }
+        else if (!irq_enabled || exclusive) {
+            drain_polled(false);
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+static void write_dropped_notice(void) {
+    u64 dropped = __atomic_exchange_n(&tx_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped == 0) {
+        return;
+    }
+
+    char buffer[64];
+    u64 index = sizeof(buffer);
+    const char suffix[] = " bytes of log dropped, serial ring full]\n";
+    index -= sizeof(suffix) - 1;
+    memcpy(buffer + index, suffix, sizeof(suffix) - 1);
+
+    u64 value = dropped;
+    do {
+        buffer[--index] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    buffer[--index] = '[';
+
+    if (!ring_write((const u8*)buffer + index, sizeof(buffer) - index, false)) {
+        __atomic_add_fetch(&tx_dropped, dropped, __ATOMIC_RELAXED);
+    }
+}
+
+// Queues the string and returns, the bytes go out from the THRE interrupt.
+// Never holds a lock while it waits: if the ring is full it waits for the
+// interrupt to drain it when interrupts are enabled, and with interrupts
+// off it drops the string and says so in a later line. A string of up to
+// SERIAL_RING_SIZE bytes comes out whole. The mirror locks for itself,
+// so its order across CPUs can differ from the serial one.
 void print_log(String string) {
-    for (u64 i = 0; i < string.len; i++) {
-        outb(PORT, string.string[i]);
+    const u8* data = (const u8*)string.string;
+    for (u64 index = 0; index < string.len; index += SERIAL_RING_SIZE) {
+        u64 count = string.len - index < SERIAL_RING_SIZE ? string.len - index : SERIAL_RING_SIZE;
+        if (!ring_write(data + index, count, false)) {
+            __atomic_add_fetch(&tx_dropped, count, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+
+    write_dropped_notice();
+
+    if (log_mirror != NULL) {
+        log_mirror(string);
+    }
+}
+
+// Binary output that bypasses the log mirror, for dumps a host tool picks
+// out of the serial stream. It owns the ring until it is done, other
+// prints wait (or drop) meanwhile, so one call is never interleaved with
+// other output. Nothing is dropped, with interrupts off it drains by
+// polling.
+void serial_write(const void* data, u64 size) {
+    while (__atomic_exchange_n(&tx_exclusive, true, __ATOMIC_ACQUIRE)) {
+        cpu_pause();
+    }
+
+    for (u64 index = 0; index < size; index += SERIAL_RING_SIZE / 4) {
+        u64 count = size - index < SERIAL_RING_SIZE / 4 ? size - index : SERIAL_RING_SIZE / 4;
+        ring_write((const u8*)data + index, count, true);
     }
+
+    __atomic_store_n(&tx_exclusive, false, __ATOMIC_RELEASE);
+}
+
+void print_log_u64(u64 value) {
+    char buffer[20];
+    u64 index = sizeof(buffer);
+
+    do {
+        buffer[--index] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    print_log((String) { buffer+index, sizeof(buffer)-index });
+}
+
+void print_log_hex(u64 value) {
+    char buffer[18];
+    u64 index = sizeof(buffer);
+
+    do {
+        buffer[--index] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+
+    buffer[--index] = 'x';
+    buffer[--index] = '0';
+    print_log((String) { buffer+index, sizeof(buffer)-index });
 }
@@ -5,4 +5,13 @@
 void outb(u16 port, u8 value);
 u8   inb(u16 port);
 int  serial_init();
+void serial_enable_interrupts(void);
+void serial_force_polled(void);
+void serial_flush(void);
+typedef void (*LogMirror)(String string);
+
+void serial_set_log_mirror(LogMirror mirror);
 void print_log(String string);
+void serial_write(const void* data, u64 size);
+void print_log_u64(u64 value);
+void print_log_hex(u64 value);
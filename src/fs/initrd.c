@@ -0,0 +1,262 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "mm/arena.h"
+#include "mem.h"
+#include "vfs.h"
+#include "initrd.h"
+
+#define CPIO_HEADER_SIZE 110
+#define CPIO_MODE_TYPE   0170000
+#define CPIO_MODE_FILE   0100000
+
+typedef struct {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char type;
+    char link_name[100];
+    char magic[6];   // "ustar\0", or "ustar " for GNU tar
+    char version[2];
+    char owner[32];
+    char group[32];
+    char device_major[8];
+    char device_minor[8];
+    char prefix[155];
+} TarHeader;
+
+static u64 parse_number(const char* field, u64 length, u32 base) {
+    u64 value = 0;
+    for (u64 i = 0; i < length; i++) {
+        char c = field[i];
+        u32 digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        }
+        else if (c == ' ' && value == 0) {
+            continue; // Tar pads numbers with leading spaces
+        }
+        else {
+            break;
+        }
+
+        if (digit >= base) {
+            break;
+        }
+
+        value = value * base + digit;
+    }
+
+    return value;
+}
+
+static u64 field_length(const char* field, u64 max) {
+    u64 length = 0;
+    while (length < max && field[length] != '\0') {
+        length++;
+    }
+
+    return length;
+}
+
+static String strip_leading_slashes(String name) {
+    while (name.len > 0 && (name.string[0] == '/' || (name.len > 1 && name.string[0] == '.' && name.string[1] == '/'))) {
+        u64 skip = name.string[0] == '/' ? 1 : 2;
+        name.string += skip;
+        name.len    -= skip;
+    }
+
+    return name;
+}
+
+// Registers "/" + prefix + "/" + name, or "/" + name without a prefix,
+// dropping a leading "./" or "/". The path is built once, in the global
+// arena, and handed to the VFS as is.
+static bool add_file(String prefix, String name, const u8* data, u64 size) {
+    prefix = strip_leading_slashes(prefix);
+    if (prefix.len == 0) {
+        name = strip_leading_slashes(name);
+    }
+
+    if (name.len == 0 || name.string[name.len - 1] == '/') {
+        return false; // Directory entries in older archives
+    }
+
+    u64   length = 1 + (prefix.len != 0 ? prefix.len + 1 : 0) + name.len;
+    char* path   = push_string(arena_ctx.global_arena, length);
+    if (path == NULL) {
+        return false;
+    }
+
+    char* out = path;
+    *out++ = '/';
+    if (prefix.len != 0) {
+        memcpy(out, prefix.string, prefix.len);
+        out += prefix.len;
+        *out++ = '/';
+    }
+    memcpy(out, name.string, name.len);
+
+    return vfs_add((String) { path, length }, data, size);
+}
+
+static bool is_tar(const u8* data, u64 size) {
+    return size >= TAR_BLOCK_SIZE && memcmp(((const TarHeader*)data)->magic, "ustar", 5) == 0;
+}
+
+static bool is_cpio(const u8* data, u64 size) {
+    return size >= CPIO_HEADER_SIZE && memcmp(data, "070701", 6) == 0;
+}
+
+// GNU long names ('L') carry the name of the next entry as file data, pax
+// headers ('x', 'g') are skipped and their attributes ignored.
+static u32 index_tar(const u8* data, u64 size) {
+    u32    files     = 0;
+    String long_name = {};
+
+    for (u64 offset = 0; offset + TAR_BLOCK_SIZE <= size;) {
+        const TarHeader* header = (const TarHeader*)(data + offset);
+        if (header->name[0] == '\0') {
+            break; // End of archive marker, two zero blocks
+        }
+
+        u64 file_size = parse_number(header->size, sizeof(header->size), 8);
+        u64 contents  = offset + TAR_BLOCK_SIZE;
+        if (contents + file_size > size) {
+            print_log(strlit("initrd: truncated tar archive\n"));
+            break;
+        }
+
+        if (header->type == 'L') {
+            long_name = (String) { (char*)data + contents, field_length((const char*)data + contents, file_size) };
+        }
+        else {
+            if (header->type == '0' || header->type == '\0') {
+                // ustar splits long paths into prefix "/" name.
+                String prefix = {};
+                String name   = long_name;
+                if (name.len == 0) {
+                    prefix = (String) { (char*)header->prefix, field_length(header->prefix, sizeof(header->prefix)) };
+                    name   = (String) { (char*)header->name, field_length(header->name, sizeof(header->name)) };
+                }
+
+                if (add_file(prefix, name, data + contents, file_size)) {
+                    files++;
+                }
+            }
+
+            long_name = (String) {};
+        }
+
+        offset = contents + (file_size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+    }
+
+    return files;
+}
+
+// newc: a 110 byte header of hex fields, the name, then the contents, with
+// both the name and the contents padded to four bytes.
+static u32 index_cpio(const u8* data, u64 size) {
+    u32 files = 0;
+
+    for (u64 offset = 0; offset + CPIO_HEADER_SIZE <= size;) {
+        const char* header = (const char*)data + offset;
+        if (memcmp(header, "070701", 6) != 0) {
+            print_log(strlit("initrd: bad cpio header\n"));
+            break;
+        }
+
+        u64 mode      = parse_number(header + 14, 8, 16);
+        u64 file_size = parse_number(header + 54, 8, 16);
+        u64 name_size = parse_number(header + 94, 8, 16); // Includes the terminator
+
+        u64 contents = (offset + CPIO_HEADER_SIZE + name_size + 3) & ~3ull;
+        if (name_size == 0 || contents + file_size > size) {
+            print_log(strlit("initrd: truncated cpio archive\n"));
+            break;
+        }
+
+        String name = { (char*)header + CPIO_HEADER_SIZE, name_size - 1 };
+        if (string_equal(name, strlit("TRAILER!!!"))) {
+            break;
+        }
+
+        if ((mode & CPIO_MODE_TYPE) == CPIO_MODE_FILE && add_file((String) {}, name, data + contents, file_size)) {
+            files++;
+        }
+
+        offset = (contents + file_size + 3) & ~3ull;
+    }
+
+    return files;
+}
+
+void initrd_init(struct limine_module_response* modules) {
+    if (modules == NULL || modules->module_count == 0) {
+        print_log(strlit("initrd: no boot modules\n"));
+        return;
+    }
+
+    TlbBatch batch = {};
+
+    for (u64 i = 0; i < modules->module_count; i++) {
+        struct limine_file* module = modules->modules[i];
+        const u8* data = module->address;
+        u64       size = module->size;
+        String    path = { module->path, field_length(module->path, 4096) };
+        if (size == 0) {
+            continue;
+        }
+
+        // Limine loads modules page aligned, so this only covers module
+        // memory. Writes through the direct map fault from here on.
+        u64 pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+        if (!vmm_map((u64)data, virt_to_phys((void*)data), pages, 0, &batch)) {
+            print_log(strlit("initrd: couldn't remap a module read-only\n"));
+        }
+
+        u32 files;
+        if (is_tar(data, size)) {
+            files = index_tar(data, size);
+        }
+        else if (is_cpio(data, size)) {
+            files = index_cpio(data, size);
+        }
+        else {
+            // Drop a "boot():" style prefix, if any, keep the path inside
+            // the volume.
+            for (u64 c = 0; c < path.len; c++) {
+                if (path.string[c] == ':') {
+                    path.string += c + 1;
+                    path.len    -= c + 1;
+                    break;
+                }
+            }
+
+            files = add_file((String) {}, path, data, size) ? 1 : 0;
+        }
+
+        print_log(strlit("initrd: "));
+        print_log(path);
+        print_log(strlit(", "));
+        print_log_u64(size);
+        print_log(strlit(" bytes, "));
+        print_log_u64(files);
+        print_log(strlit(" files\n"));
+    }
+
+    tlb_batch_flush(&batch);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Boot modules from limine.conf (module_path), used where the bootloader
+// left them. Each module is remapped read-only in the direct map and its
+// files are registered with the VFS in place, nothing is copied:
+//
+//     ustar archive   every regular file, at "/" + its name in the archive
+//     cpio (newc)     same
+//     anything else   the module itself, at its Limine path
+//
+// Needs vfs_init() and the VMM.
+
+struct limine_module_response;
+
+#define TAR_BLOCK_SIZE 512
+
+void initrd_init(struct limine_module_response* modules);
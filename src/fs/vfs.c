@@ -0,0 +1,146 @@
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "mm/arena.h"
+#include "mem.h"
+#include "vfs.h"
+
+typedef struct {
+    u64      hash; // Cached so probes and rehashing rarely touch the path
+    VfsFile* file; // NULL for an empty bucket
+} VfsBucket;
+
+static VfsBucket* buckets;
+static u64        bucket_count;
+static u64        file_count;
+
+static VfsBucket* find_bucket(VfsBucket* table, u64 count, String path, u64 hash) {
+    u64 mask = count - 1;
+    for (u64 i = hash & mask;; i = (i + 1) & mask) {
+        VfsBucket* bucket = &table[i];
+        if (bucket->file == NULL || (bucket->hash == hash && string_equal(bucket->file->path, path))) {
+            return bucket;
+        }
+    }
+}
+
+static VfsBucket* alloc_table(u64 count) {
+    VfsBucket* table = push_array(arena_ctx.global_arena, VfsBucket, count);
+    if (table != NULL) {
+        memset(table, 0, count * sizeof(VfsBucket));
+    }
+
+    return table;
+}
+
+// Doubles the table. The old one stays in the arena, the index only grows
+// during boot so at most half of what it ever used is wasted.
+static bool grow(void) {
+    u64 count = bucket_count * 2;
+    VfsBucket* table = alloc_table(count);
+    if (table == NULL) {
+        return false;
+    }
+
+    for (u64 i = 0; i < bucket_count; i++) {
+        if (buckets[i].file != NULL) {
+            *find_bucket(table, count, buckets[i].file->path, buckets[i].hash) = buckets[i];
+        }
+    }
+
+    buckets      = table;
+    bucket_count = count;
+    return true;
+}
+
+void vfs_init(void) {
+    buckets      = alloc_table(VFS_INITIAL_BUCKETS);
+    bucket_count = VFS_INITIAL_BUCKETS;
+    file_count   = 0;
+    if (buckets == NULL) {
+        print_log(strlit("vfs: out of memory for the path index\n"));
+    }
+}
+
+// Neither the path nor the contents are copied, both must stay in place
+// for as long as the kernel runs. A second file with the same path replaces
+// the first.
+bool vfs_add(String path, const u8* data, u64 size) {
+    if (buckets == NULL || path.len == 0 || path.string[0] != '/') {
+        return false;
+    }
+
+    // Keep the load factor at or below one half.
+    if ((file_count + 1) * 2 > bucket_count && !grow()) {
+        return false;
+    }
+
+    u64 hash = string_hash(path);
+    VfsBucket* bucket = find_bucket(buckets, bucket_count, path, hash);
+    if (bucket->file != NULL) {
+        bucket->file->data = data;
+        bucket->file->size = size;
+        return true;
+    }
+
+    VfsFile* file = push_struct(arena_ctx.global_arena, VfsFile);
+    if (file == NULL) {
+        return false;
+    }
+
+    *file = (VfsFile) {
+        .path = path,
+        .data = data,
+        .size = size
+    };
+
+    bucket->hash = hash;
+    bucket->file = file;
+    file_count++;
+    return true;
+}
+
+const VfsFile* vfs_open(String path) {
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    return find_bucket(buckets, bucket_count, path, string_hash(path))->file;
+}
+
+// For callers that need their own copy, most can use file->data directly.
+u64 vfs_read(const VfsFile* file, u64 offset, void* buffer, u64 size) {
+    if (offset >= file->size) {
+        return 0;
+    }
+
+    if (size > file->size - offset) {
+        size = file->size - offset;
+    }
+
+    memcpy(buffer, file->data + offset, size);
+    return size;
+}
+
+u64 vfs_file_count(void) {
+    return file_count;
+}
+
+void vfs_print(void) {
+    print_log(strlit("vfs: "));
+    print_log_u64(file_count);
+    print_log(strlit(" files\n"));
+
+    for (u64 i = 0; i < bucket_count; i++) {
+        VfsFile* file = buckets[i].file;
+        if (file == NULL) {
+            continue;
+        }
+
+        print_log(strlit("  "));
+        print_log(file->path);
+        print_log(strlit(" ("));
+        print_log_u64(file->size);
+        print_log(strlit(" bytes)\n"));
+    }
+}
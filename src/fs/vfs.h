@@ -0,0 +1,23 @@
+#pragma once
+
+// Read-only file lookup. Files are registered during boot with a path and
+// contents that already sit in memory (boot modules, see fs/initrd.h), and
+// neither is copied. Paths are absolute, "/" separated, and found through an
+// open addressing hash table, so vfs_open() costs one hash and usually a
+// single probe. The index is only written while the kernel is still single
+// threaded, lookups afterwards take no lock.
+
+#define VFS_INITIAL_BUCKETS 64 // A power of two
+
+typedef struct {
+    String    path;
+    const u8* data;
+    u64       size;
+} VfsFile;
+
+void           vfs_init(void);
+bool           vfs_add(String path, const u8* data, u64 size);
+const VfsFile* vfs_open(String path);
+u64            vfs_read(const VfsFile* file, u64 offset, void* buffer, u64 size);
+u64            vfs_file_count(void);
+void           vfs_print(void);
@@ -0,0 +1,229 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "sched/sched.h"
+#include "mem.h"
+#include "gfx.h"
+#include "console.h"
+
+#define PSF1_MAGIC      0x0436
+#define PSF1_MODE_512   0x01
+#define PSF2_MAGIC      0x864AB572
+#define CONSOLE_GLYPHS  256
+#define CONSOLE_TAB     8
+
+typedef struct __attribute__((packed)) {
+    u16 magic;
+    u8  mode;
+    u8  charsize;
+} Psf1Header;
+
+typedef struct __attribute__((packed)) {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 flags;
+    u32 glyph_count;
+    u32 bytes_per_glyph;
+    u32 height;
+    u32 width;
+} Psf2Header;
+
+extern const u8  console_font_psf[];
+extern const u64 console_font_psf_size;
+
+static const u8* glyph_bitmaps;
+static u32       glyph_count;
+static u32       glyph_width;
+static u32       glyph_height;
+static u32       bytes_per_glyph;
+static u32       bytes_per_row;
+
+// Expanded glyphs, glyph_width*glyph_height pixels each. glyph_cached has a
+// bit per glyph and is cleared whenever the colors change.
+static u32* glyph_cache;
+static u64  glyph_cached[CONSOLE_GLYPHS / 64];
+
+// Covers the cursor and the glyph cache. Held with interrupts off, so it
+// only ever covers drawing into the back buffer, never a present.
+static Spinlock console_lock;
+static bool     presenter_running;
+
+static u32 foreground = CONSOLE_DEFAULT_FOREGROUND;
+static u32 background = CONSOLE_DEFAULT_BACKGROUND;
+static u32 columns;
+static u32 rows;
+static u32 cursor_x;
+static u32 cursor_y;
+
+static bool parse_font(const u8* font, u64 size) {
+    const Psf1Header* psf1 = (const Psf1Header*)font;
+    const Psf2Header* psf2 = (const Psf2Header*)font;
+
+    if (size >= sizeof(Psf1Header) && psf1->magic == PSF1_MAGIC) {
+        glyph_count     = (psf1->mode & PSF1_MODE_512) ? 512 : 256;
+        glyph_width     = 8;
+        glyph_height    = psf1->charsize;
+        bytes_per_row   = 1;
+        bytes_per_glyph = psf1->charsize;
+        glyph_bitmaps   = font + sizeof(Psf1Header);
+    }
+    else if (size >= sizeof(Psf2Header) && psf2->magic == PSF2_MAGIC) {
+        glyph_count     = psf2->glyph_count;
+        glyph_width     = psf2->width;
+        glyph_height    = psf2->height;
+        bytes_per_row   = (psf2->width + 7) / 8;
+        bytes_per_glyph = psf2->bytes_per_glyph;
+        glyph_bitmaps   = font + psf2->header_size;
+    }
+    else {
+        return false;
+    }
+
+    u64 glyph_bytes = (u64)glyph_count * bytes_per_glyph;
+    return glyph_width != 0 && glyph_height != 0 &&
+           bytes_per_glyph >= bytes_per_row * glyph_height &&
+           glyph_bitmaps + glyph_bytes <= font + size;
+}
+
+static const u32* cached_glyph(u8 c) {
+    u32* pixels = glyph_cache + (u64)c * glyph_width * glyph_height;
+    if (glyph_cached[c / 64] & (1ull << (c % 64))) {
+        return pixels;
+    }
+
+    u32 index = c < glyph_count ? c : '?';
+    const u8* bitmap = glyph_bitmaps + (u64)index * bytes_per_glyph;
+
+    for (u32 y = 0; y < glyph_height; y++) {
+        const u8* row = bitmap + y * bytes_per_row;
+        for (u32 x = 0; x < glyph_width; x++) {
+            bool set = row[x / 8] & (0x80 >> (x % 8));
+            *pixels++ = set ? foreground : background;
+        }
+    }
+
+    glyph_cached[c / 64] |= 1ull << (c % 64);
+    return pixels - glyph_width * glyph_height;
+}
+
+static void newline(void) {
+    cursor_x = 0;
+    if (cursor_y + 1 < rows) {
+        cursor_y++;
+        return;
+    }
+
+    gfx_scroll(glyph_height, background);
+}
+
+static void mirror_log(String string) {
+    console_write(string);
+}
+
+bool console_init(void) {
+    if (!parse_font(console_font_psf, console_font_psf_size)) {
+        print_log(strlit("console: bad PSF font\n"));
+        return false;
+    }
+
+    u64 cache_bytes = (u64)CONSOLE_GLYPHS * glyph_width * glyph_height * sizeof(u32);
+    glyph_cache = vmm_alloc((cache_bytes + PAGE_SIZE - 1) / PAGE_SIZE, VMM_FLAG_WRITE);
+    if (glyph_cache == NULL) {
+        print_log(strlit("console: out of memory for the glyph cache\n"));
+        return false;
+    }
+
+    columns  = gfx_width() / glyph_width;
+    rows     = gfx_height() / glyph_height;
+    cursor_x = 0;
+    cursor_y = 0;
+    if (columns == 0 || rows == 0) {
+        return false;
+    }
+
+    gfx_fill_rect(0, 0, gfx_width(), gfx_height(), background);
+    gfx_present();
+    serial_set_log_mirror(mirror_log);
+    return true;
+}
+
+// Presents whatever the console drew since the last time.
+static void presenter(void* argument) {
+    for (;;) {
+        thread_sleep_ns(CONSOLE_PRESENT_MS * 1000000ull);
+        gfx_present();
+    }
+}
+
+// From here on console_write() only draws and the presenter thread copies
+// to the screen, so heavy logging costs the glyph blits and no more.
+void console_start_presenter(void) {
+    if (glyph_cache == NULL) {
+        return;
+    }
+
+    if (thread_create(strlit("console"), presenter, NULL, SCHED_ANY_CPU) == NULL) {
+        print_log(strlit("console: no presenter thread, presenting per line\n"));
+        return;
+    }
+
+    __atomic_store_n(&presenter_running, true, __ATOMIC_RELEASE);
+}
+
+void console_set_colors(u32 new_foreground, u32 new_background) {
+    u64 flags = spin_lock_irqsave(&console_lock);
+    if (new_foreground != foreground || new_background != background) {
+        foreground = new_foreground;
+        background = new_background;
+        memset(glyph_cached, 0, sizeof(glyph_cached));
+    }
+    spin_unlock_irqrestore(&console_lock, flags);
+}
+
+// Draws the string at the cursor. Until the presenter thread runs it also
+// presents, outside the lock and only for strings that end a line.
+void console_write(String string) {
+    if (glyph_cache == NULL) {
+        return;
+    }
+
+    u64 flags = spin_lock_irqsave(&console_lock);
+    for (u64 i = 0; i < string.len; i++) {
+        u8 c = string.string[i];
+
+        if (c == '\n') {
+            newline();
+            continue;
+        }
+        else if (c == '\r') {
+            cursor_x = 0;
+            continue;
+        }
+        else if (c == '\t') {
+            cursor_x = (cursor_x / CONSOLE_TAB + 1) * CONSOLE_TAB;
+            if (cursor_x >= columns) {
+                newline();
+            }
+            continue;
+        }
+
+        if (cursor_x >= columns) {
+            newline();
+        }
+
+        gfx_blit(cursor_x * glyph_width, cursor_y * glyph_height,
+                 glyph_width, glyph_height, cached_glyph(c), glyph_width);
+        cursor_x++;
+    }
+    spin_unlock_irqrestore(&console_lock, flags);
+
+    bool line_ended = string.len != 0 && string.string[string.len-1] == '\n';
+    if (line_ended && !__atomic_load_n(&presenter_running, __ATOMIC_ACQUIRE)) {
+        gfx_present();
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Text console drawn on the back buffer with a PSF1 or PSF2 bitmap font.
+// Every glyph is expanded to 32-bit pixels in the current colors the first
+// time it is used, after that a character is a single gfx_blit(). Once
+// initialised it mirrors everything written with print_log(). Writes only
+// draw into the back buffer; a thread presents it every CONSOLE_PRESENT_MS
+// once the scheduler is up.
+
+#define CONSOLE_DEFAULT_FOREGROUND 0xAAAAAA
+#define CONSOLE_DEFAULT_BACKGROUND 0x000000
+#define CONSOLE_PRESENT_MS         16 // About 60 presents a second
+
+bool console_init(void);
+void console_start_presenter(void);
+void console_set_colors(u32 foreground, u32 background);
+void console_write(String string);
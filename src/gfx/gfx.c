@@ -0,0 +1,244 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "mem.h"
+#include "gfx.h"
+
+static u8*  framebuffer_base;
+static u64  framebuffer_pitch;
+static u32* back_buffer; // NULL if there was no memory for one
+static u32* draw_base;   // The back buffer, or the framebuffer without one
+static u64  draw_stride; // Pixels from one row of draw_base to the next
+static u32  screen_width;
+static u32  screen_height;
+
+static GfxRect dirty_rects[GFX_MAX_DIRTY_RECTS];
+static u32     dirty_count;
+
+// Drawing can come from any CPU, through the console mirror for one.
+// gfx_lock covers the back buffer and the dirty set and is irqsave, the
+// mirror may run in an interrupt handler. present_lock keeps presents from
+// running over each other. A present only holds gfx_lock to take the dirty
+// set, the copy to the framebuffer runs without it.
+static Spinlock gfx_lock;
+static Spinlock present_lock;
+
+// Clips `rect` to the screen, false when nothing is left.
+static bool clip_to_screen(GfxRect* rect) {
+    i64 x0 = rect->x, y0 = rect->y;
+    i64 x1 = x0 + rect->width, y1 = y0 + rect->height;
+
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > screen_width  ? screen_width  : x1;
+    y1 = y1 > screen_height ? screen_height : y1;
+
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+
+    *rect = (GfxRect) { x0, y0, x1 - x0, y1 - y0 };
+    return true;
+}
+
+static bool rects_touch(GfxRect a, GfxRect b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+static GfxRect rect_union(GfxRect a, GfxRect b) {
+    i32 x0 = a.x < b.x ? a.x : b.x;
+    i32 y0 = a.y < b.y ? a.y : b.y;
+    i32 x1 = a.x + a.width  > b.x + b.width  ? a.x + a.width  : b.x + b.width;
+    i32 y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return (GfxRect) { x0, y0, x1 - x0, y1 - y0 };
+}
+
+// Adds `rect` to the dirty set. Rects that touch are merged so the same
+// pixels aren't copied twice, and when the set is full everything collapses
+// into one bounding box, which costs some extra copying but never misses a
+// pixel.
+static void mark_dirty(GfxRect rect) {
+    if (back_buffer == NULL || !clip_to_screen(&rect)) {
+        return;
+    }
+
+    // A merge can make the grown rect touch ones it didn't before, keep
+    // going until it settles.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (u32 i = 0; i < dirty_count; i++) {
+            if (rects_touch(dirty_rects[i], rect)) {
+                rect = rect_union(dirty_rects[i], rect);
+                dirty_rects[i] = dirty_rects[--dirty_count];
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (dirty_count == GFX_MAX_DIRTY_RECTS) {
+        for (u32 i = 0; i < dirty_count; i++) {
+            rect = rect_union(dirty_rects[i], rect);
+        }
+
+        dirty_count = 0;
+    }
+
+    dirty_rects[dirty_count++] = rect;
+}
+
+bool gfx_init(struct limine_framebuffer* framebuffer) {
+    if (framebuffer->bpp != 32) {
+        print_log(strlit("gfx: only 32 bpp framebuffers are supported\n"));
+        return false;
+    }
+
+    u64 size  = framebuffer->width * framebuffer->height * sizeof(u32);
+    u64 pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    framebuffer_base  = framebuffer->address;
+    framebuffer_pitch = framebuffer->pitch;
+    screen_width      = framebuffer->width;
+    screen_height     = framebuffer->height;
+    dirty_count       = 0;
+
+    // A large screen in a small guest may not leave room for the back
+    // buffer. Drawing then goes straight to the framebuffer, slower but
+    // still correct, and presents have nothing to do.
+    back_buffer = vmm_alloc(pages, VMM_FLAG_WRITE);
+    if (back_buffer == NULL) {
+        print_log(strlit("gfx: no memory for a back buffer, drawing to the framebuffer directly\n"));
+        draw_base   = (u32*)framebuffer_base;
+        draw_stride = framebuffer_pitch / sizeof(u32);
+        return true;
+    }
+
+    draw_base   = back_buffer;
+    draw_stride = screen_width;
+    memset(back_buffer, 0, size);
+    return true;
+}
+
+u32 gfx_width(void) {
+    return screen_width;
+}
+
+u32 gfx_height(void) {
+    return screen_height;
+}
+
+void gfx_fill_rect(i32 x, i32 y, i32 width, i32 height, u32 color) {
+    GfxRect rect = { x, y, width, height };
+    if (!clip_to_screen(&rect)) {
+        return;
+    }
+
+    u64 flags = spin_lock_irqsave(&gfx_lock);
+    u32* row = draw_base + (u64)rect.y * draw_stride + rect.x;
+    for (i32 i = 0; i < rect.height; i++) {
+        memset32(row, color, rect.width);
+        row += draw_stride;
+    }
+
+    mark_dirty(rect);
+    spin_unlock_irqrestore(&gfx_lock, flags);
+}
+
+// Copies a `width` x `height` block of pixels to (x, y). `stride` is the
+// distance between rows of the source in pixels.
+void gfx_blit(i32 x, i32 y, i32 width, i32 height, const u32* pixels, u64 stride) {
+    GfxRect rect = { x, y, width, height };
+    if (!clip_to_screen(&rect)) {
+        return;
+    }
+
+    u64 flags = spin_lock_irqsave(&gfx_lock);
+    const u32* src = pixels + (u64)(rect.y - y) * stride + (rect.x - x);
+    u32*       dst = draw_base + (u64)rect.y * draw_stride + rect.x;
+    for (i32 i = 0; i < rect.height; i++) {
+        memcpy(dst, src, rect.width * sizeof(u32));
+        src += stride;
+        dst += draw_stride;
+    }
+
+    mark_dirty(rect);
+    spin_unlock_irqrestore(&gfx_lock, flags);
+}
+
+// Moves the whole screen up by `lines` pixel rows and clears the rows that
+// come in at the bottom. Rows without padding between them move with a
+// single memmove, the framebuffer's padded ones a row at a time.
+void gfx_scroll(u32 lines, u32 fill_color) {
+    if (lines >= screen_height) {
+        gfx_fill_rect(0, 0, screen_width, screen_height, fill_color);
+        return;
+    }
+
+    u64 flags = spin_lock_irqsave(&gfx_lock);
+    u32 kept  = screen_height - lines;
+    if (draw_stride == screen_width) {
+        memmove(draw_base, draw_base + (u64)lines * screen_width, (u64)kept * screen_width * sizeof(u32));
+        memset32(draw_base + (u64)kept * screen_width, fill_color, (u64)lines * screen_width);
+    }
+    else {
+        for (u32 y = 0; y < kept; y++) {
+            memcpy(draw_base + y * draw_stride, draw_base + (y + lines) * draw_stride, screen_width * sizeof(u32));
+        }
+        for (u32 y = kept; y < screen_height; y++) {
+            memset32(draw_base + y * draw_stride, fill_color, screen_width);
+        }
+    }
+
+    mark_dirty((GfxRect) { 0, 0, screen_width, screen_height });
+    spin_unlock_irqrestore(&gfx_lock, flags);
+}
+
+void gfx_mark_dirty(GfxRect rect) {
+    u64 flags = spin_lock_irqsave(&gfx_lock);
+    mark_dirty(rect);
+    spin_unlock_irqrestore(&gfx_lock, flags);
+}
+
+// Copies every dirty rect to the framebuffer a scanline at a time. Each row
+// is a single memcpy, which turns into rep movsb and lets the write-combining
+// buffers merge the stores into full-line bursts.
+//
+// The dirty set is taken and the copy runs unlocked, so drawing on other
+// CPUs isn't held up by it. Pixels drawn during the copy may come out torn,
+// but their rects are marked again and the next present fixes them. If
+// another present is already running this one returns at once, what it
+// leaves dirty waits for the next.
+void gfx_present(void) {
+    if (back_buffer == NULL || !spin_try_lock(&present_lock)) {
+        return;
+    }
+
+    GfxRect rects[GFX_MAX_DIRTY_RECTS];
+    u64 flags = spin_lock_irqsave(&gfx_lock);
+    u32 count = dirty_count;
+    memcpy(rects, dirty_rects, count * sizeof(GfxRect));
+    dirty_count = 0;
+    spin_unlock_irqrestore(&gfx_lock, flags);
+
+    for (u32 i = 0; i < count; i++) {
+        GfxRect rect = rects[i];
+        u64 row_bytes = (u64)rect.width * sizeof(u32);
+
+        const u32* src = back_buffer + (u64)rect.y * screen_width + rect.x;
+        u8*        dst = framebuffer_base + (u64)rect.y * framebuffer_pitch + (u64)rect.x * sizeof(u32);
+        for (i32 y = 0; y < rect.height; y++) {
+            memcpy(dst, src, row_bytes);
+            src += screen_width;
+            dst += framebuffer_pitch;
+        }
+    }
+
+    spin_unlock(&present_lock);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Software rendering on top of the Limine framebuffer. Drawing goes to a
+// back buffer in ordinary cached memory, one scanline at a time. The real
+// framebuffer is write-combined and very slow to read, so it is only ever
+// written to, by gfx_present() copying out the rectangles touched since the
+// last present. Without memory for the back buffer drawing goes straight to
+// the framebuffer and gfx_present() does nothing. Every function may be
+// called from any CPU, also with interrupts off.
+
+struct limine_framebuffer;
+
+#define GFX_MAX_DIRTY_RECTS 16
+
+typedef struct {
+    i32 x;
+    i32 y;
+    i32 width;
+    i32 height;
+} GfxRect;
+
+bool gfx_init(struct limine_framebuffer* framebuffer);
+u32  gfx_width(void);
+u32  gfx_height(void);
+void gfx_fill_rect(i32 x, i32 y, i32 width, i32 height, u32 color);
+void gfx_blit(i32 x, i32 y, i32 width, i32 height, const u32* pixels, u64 stride);
+void gfx_scroll(u32 lines, u32 fill_color);
+void gfx_mark_dirty(GfxRect rect);
+void gfx_present(void);
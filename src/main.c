@@ -2,6 +2,36 @@
 #include <util.h>
 #include <string.h>
 #include "drivers/serial.h"
+#include "drivers/pic.h"
+#include "acpi/acpi.h"
+#include "mem.h"
+#include "panic.h"
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "cpu/gdt.h"
+#include "cpu/idt.h"
+#include "sched/run_queue.h"
+#include "sched/sched.h"
+#include "cpu/percpu.h"
+#include "cpu/smp.h"
+#include "drivers/lapic.h"
+#include "drivers/irq.h"
+#include "drivers/keyboard.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "mm/slab.h"
+#include "mm/kmalloc.h"
+#include "mm/vm.h"
+#include "mm/arena.h"
+#include "gfx/gfx.h"
+#include "gfx/console.h"
+#include "time/tsc.h"
+#include "time/timer.h"
+#include "time/boot_profile.h"
+#include "trace/trace.h"
+#include "fs/vfs.h"
+#include "fs/initrd.h"
+#include "bench/bench.h"
 
 __attribute__((used, section(".limine_requests")))
 static volatile LIMINE_BASE_REVISION(3);
@@ -13,114 +43,201 @@ static volatile struct limine_framebuffer_request framebuffer_request = {
     .response = NULL
 };
 
-__attribute__((used, section(".limine_requests_start")))
-static volatile LIMINE_REQUESTS_START_MARKER;
-
-__attribute__((used, section(".limine_requests_end")))
-static volatile LIMINE_REQUESTS_END_MARKER;
-
-
-void* memcpy(void* dest, const void* src, u64 n) {
-    u8 *pdest = (u8 *)dest;
-    const u8 *psrc = (const u8 *)src;
-
-    for (u64 i = 0; i < n; i++) {
-        pdest[i] = psrc[i];
-    }
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_hhdm_request hhdm_request = {
+    .id = LIMINE_HHDM_REQUEST,
+    .revision = 0,
+    .response = NULL
+};
 
-    return dest;
-}
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_memmap_request memmap_request = {
+    .id = LIMINE_MEMMAP_REQUEST,
+    .revision = 0,
+    .response = NULL
+};
 
-void *memset(void *s, int c, u64 n) {
-    u8 *p = (u8 *)s;
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_executable_address_request executable_address_request = {
+    .id = LIMINE_EXECUTABLE_ADDRESS_REQUEST,
+    .revision = 0,
+    .response = NULL
+};
 
-    for (u64 i = 0; i < n; i++) {
-        p[i] = (u8)c;
-    }
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_mp_request mp_request = {
+    .id = LIMINE_MP_REQUEST,
+    .revision = 0,
+    .response = NULL,
+    .flags = 0
+};
 
-    return s;
-}
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_module_request module_request = {
+    .id = LIMINE_MODULE_REQUEST,
+    .revision = 0,
+    .response = NULL
+};
 
-void* memmove(void* dest, const void* src, u64 n) {
-    u8 *pdest = (u8 *)dest;
-    const u8 *psrc = (const u8 *)src;
-
-    if (src > dest) {
-        for (u64 i = 0; i < n; i++) {
-            pdest[i] = psrc[i];
-        }
-    } else if (src < dest) {
-        for (u64 i = n; i > 0; i--) {
-            pdest[i-1] = psrc[i-1];
-        }
-    }
+__attribute__((used, section(".limine_requests")))
+static volatile struct limine_rsdp_request rsdp_request = {
+    .id = LIMINE_RSDP_REQUEST,
+    .revision = 0,
+    .response = NULL
+};
 
-    return dest;
-}
+__attribute__((used, section(".limine_requests_start")))
+static volatile LIMINE_REQUESTS_START_MARKER;
 
-int memcmp(const void* s1, const void* s2, u64 n) {
-    const u8 *p1 = (const u8 *)s1;
-    const u8 *p2 = (const u8 *)s2;
+__attribute__((used, section(".limine_requests_end")))
+static volatile LIMINE_REQUESTS_END_MARKER;
 
-    for (u64 i = 0; i < n; i++) {
-        if (p1[i] != p2[i]) {
-            return p1[i] < p2[i] ? -1 : 1;
-        }
-    }
 
-    return 0;
+#ifdef KERNEL_BENCH
+// Benchmarks run one after another in a thread of their own, the
+// scheduler bench needs to yield. Nothing else is started alongside.
+static void run_benches(void* argument) {
+    mem_bench();
+    gfx_bench((struct limine_framebuffer*)argument);
+    trace_bench();
+    vm_bench();
+    timer_bench();
+    kmalloc_bench();
+    sync_bench();
+    sched_bench();
+    bench_finish();
 }
-
-// Halt and catch fire function.
-void hcf(void) {
-    for (;;) {
-        asm ("hlt");
-    }
+#else
+static u32 hellos_done;
+
+static void say_hello(void* argument) {
+    PerCpu* cpu = this_cpu();
+    print_log(strlit("smp: hello from cpu "));
+    print_log_u64(cpu->cpu_id);
+    print_log(strlit(" (lapic "));
+    print_log_u64(cpu->lapic_id);
+    print_log(strlit(")\n"));
+    __atomic_add_fetch(&hellos_done, 1, __ATOMIC_RELEASE);
 }
 
-
-bool framebuffer_draw_pixel(struct limine_framebuffer* framebuffer, u32 x, u32 y, u64 color) {
-    if (x > framebuffer->width || y > framebuffer->height) {
-        return false;
+static void report_when_settled(void* argument) {
+    while (__atomic_load_n(&hellos_done, __ATOMIC_ACQUIRE) < percpu_count()) {
+        thread_yield();
     }
 
-    u32* screen = framebuffer->address;
-    u32 pitch_per_pixel = framebuffer->pitch/(framebuffer->bpp/8);
-    screen[pitch_per_pixel*y+x] = color;
-    return true;
+    sched_print_stats();
+    timer_print_stats();
+    kmalloc_print_stats();
+    vm_print_stats();
+    trace_dump();
 }
+#endif
 
 void main(void) {
+    boot_profile_start();
+
+    mem_init();
+    percpu_init_bsp();
+    boot_phase(strlit("mem_init"));
+
     // Ensure the bootloader actually understands our base revision (see spec).
     if (LIMINE_BASE_REVISION_SUPPORTED == false) {
         hcf();
     }
+    boot_phase(strlit("base revision check"));
 
-    if (framebuffer_request.response == NULL || framebuffer_request.response->framebuffer_count < 1) {
-        hcf();
-    }
+    serial_init();
+    boot_phase(strlit("serial_init"));
 
-    struct limine_framebuffer* framebuffer = framebuffer_request.response->framebuffers[0];
+    tsc_init();
+    boot_phase(strlit("tsc_init"));
 
-    for (u32 i = 20; i < 800; i++) {
-        framebuffer_draw_pixel(framebuffer, i, 40,  0xFFFFFF);
-        framebuffer_draw_pixel(framebuffer, i, 500, 0xFFFFFF);
+    if (hhdm_request.response == NULL ||
+            memmap_request.response == NULL ||
+            executable_address_request.response == NULL)
+    {
+        panic(strlit("Limine did not provide the HHDM, memory map or executable address"));
     }
 
-    for (u32 i = 40; i < 500; i++) {
-        framebuffer_draw_pixel(framebuffer, 20, i, 0xFFFFFF);
-        framebuffer_draw_pixel(framebuffer, 800, i, 0xFFFFFF);
+    pmm_init(memmap_request.response, hhdm_request.response->offset);
+    boot_phase(strlit("pmm_init"));
+    vmm_init(memmap_request.response, executable_address_request.response);
+    boot_phase(strlit("vmm_init"));
+
+    if (framebuffer_request.response == NULL || framebuffer_request.response->framebuffer_count < 1) {
+        hcf();
     }
 
-    for (u32 y = 41; y < 500; y++) {
-        for (u32 x = 21; x < 800; x++) {
-            framebuffer_draw_pixel(framebuffer, x, y, 0xFF00FF);
-        }
+    struct limine_framebuffer* framebuffer = framebuffer_request.response->framebuffers[0];
+    if (!gfx_init(framebuffer)) {
+        hcf();
+    }
+    boot_phase(strlit("framebuffer setup"));
+
+    console_init();
+    boot_phase(strlit("console_init"));
+    gdt_init();
+    boot_phase(strlit("gdt_init"));
+    idt_init();
+    boot_phase(strlit("idt_init"));
+    pic_init();
+    lapic_init();
+    acpi_init(rsdp_request.response);
+    irq_init(acpi_madt());
+    serial_enable_interrupts();
+    keyboard_init();
+    interrupts_enable();
+    boot_phase(strlit("apic, serial and keyboard interrupts"));
+    slab_init();
+    kmalloc_init();
+    boot_phase(strlit("slab_init"));
+    vm_init();
+    boot_phase(strlit("vm_init"));
+    arena_context_init(KB(64), KB(64));
+    boot_phase(strlit("arena_context_init"));
+    pmm_print_stats();
+    slab_print_stats();
+    boot_phase(strlit("memory stats"));
+    vfs_init();
+    initrd_init(module_request.response);
+    boot_phase(strlit("initrd_init"));
+
+    const VfsFile* motd = vfs_open(strlit("/etc/motd"));
+    if (motd != NULL) {
+        print_log((String) { (char*)motd->data, motd->size });
     }
 
-    serial_init();
+    trace_init();
+    boot_phase(strlit("trace_init"));
+    sched_init();
+    console_start_presenter();
+    boot_phase(strlit("sched_init"));
+    smp_init(mp_request.response);
+    irq_balance();
+    irq_print_routes();
+    boot_phase(strlit("smp_init"));
+
+    gfx_fill_rect(20,  40,  780, 1,   0xFFFFFF);
+    gfx_fill_rect(20,  500, 780, 1,   0xFFFFFF);
+    gfx_fill_rect(20,  40,  1,   460, 0xFFFFFF);
+    gfx_fill_rect(800, 40,  1,   460, 0xFFFFFF);
+    gfx_fill_rect(21,  41,  779, 459, 0xFF00FF);
+    boot_phase(strlit("draw"));
+    gfx_present();
+    boot_phase(strlit("present"));
+
+    boot_profile_report();
 
     /* print_log(strlit("hello world\n")); */
 
-    hcf();
+#ifdef KERNEL_BENCH
+    thread_create(strlit("bench"), run_benches, framebuffer, 0);
+#else
+    for (u32 i = 0; i < percpu_count(); i++) {
+        thread_create(strlit("hello"), say_hello, NULL, i);
+    }
+
+    thread_create(strlit("report"), report_when_settled, NULL, 0);
+#endif
+    sched_idle_loop();
 }
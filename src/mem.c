@@ -0,0 +1,237 @@
+#include <util.h>
+#include "cpu/cpu.h"
+#include "mem.h"
+
+// Copies and fills at least this large go through rep movsb/stosb when the
+// CPU advertises ERMS, or through rep movsq/stosq otherwise. Below it the
+// startup cost of the string instructions outweighs the word loop.
+#define MEM_REP_THRESHOLD 256
+
+// Keep the compiler from recognising the loops below as memcpy/memset and
+// turning them back into calls to themselves once optimisations are on.
+#if defined(__clang__)
+#define MEM_FUNCTION __attribute__((no_builtin))
+#else
+#define MEM_FUNCTION __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#endif
+
+// x86 handles misaligned loads fine, this just tells the compiler that.
+typedef u64 __attribute__((may_alias, aligned(1))) unaligned_u64;
+
+static MemFeatures features;
+
+void mem_init(void) {
+    if (cpuid_max_leaf() < 7) {
+        return;
+    }
+
+    CpuidResult leaf7 = cpuid(7, 0);
+    features.erms = (leaf7.ebx & CPUID_7_EBX_ERMS) != 0;
+    features.fsrm = (leaf7.edx & CPUID_7_EDX_FSRM) != 0;
+}
+
+MemFeatures mem_features(void) {
+    return features;
+}
+
+static inline void rep_movsb(void* dest, const void* src, u64 n) {
+    asm volatile (
+            "rep movsb"
+            : "+D" (dest), "+S" (src), "+c" (n)
+            :
+            : "memory"
+    );
+}
+
+static inline void rep_movsq(void* dest, const void* src, u64 count) {
+    asm volatile (
+            "rep movsq"
+            : "+D" (dest), "+S" (src), "+c" (count)
+            :
+            : "memory"
+    );
+}
+
+static inline void rep_stosb(void* dest, u8 value, u64 n) {
+    asm volatile (
+            "rep stosb"
+            : "+D" (dest), "+c" (n)
+            : "a" (value)
+            : "memory"
+    );
+}
+
+static inline void rep_stosq(void* dest, u64 value, u64 count) {
+    asm volatile (
+            "rep stosq"
+            : "+D" (dest), "+c" (count)
+            : "a" (value)
+            : "memory"
+    );
+}
+
+MEM_FUNCTION void* memcpy(void* dest, const void* src, u64 n) {
+    if (features.fsrm || (features.erms && n >= MEM_REP_THRESHOLD)) {
+        rep_movsb(dest, src, n);
+        return dest;
+    }
+
+    u8* pdest = (u8*)dest;
+    const u8* psrc = (const u8*)src;
+
+    if (n >= 8) {
+        // Bring the destination up to an 8 byte boundary so every word store
+        // is aligned, the loads can stay misaligned.
+        u64 head = (-(uintptr_t)pdest) & 7;
+        n -= head;
+        while (head--) {
+            *pdest++ = *psrc++;
+        }
+
+        u64 words = n / 8;
+        if (n >= MEM_REP_THRESHOLD) {
+            rep_movsq(pdest, psrc, words);
+        }
+        else {
+            for (u64 i = 0; i < words; i++) {
+                ((u64*)pdest)[i] = ((const unaligned_u64*)psrc)[i];
+            }
+        }
+
+        pdest += words*8;
+        psrc  += words*8;
+        n &= 7;
+    }
+
+    while (n--) {
+        *pdest++ = *psrc++;
+    }
+
+    return dest;
+}
+
+MEM_FUNCTION void* memset(void* s, int c, u64 n) {
+    if (features.erms && n >= MEM_REP_THRESHOLD) {
+        rep_stosb(s, (u8)c, n);
+        return s;
+    }
+
+    u8* p = (u8*)s;
+
+    if (n >= 8) {
+        u64 pattern = (u8)c * 0x0101010101010101ull;
+
+        u64 head = (-(uintptr_t)p) & 7;
+        n -= head;
+        while (head--) {
+            *p++ = (u8)c;
+        }
+
+        u64 words = n / 8;
+        if (n >= MEM_REP_THRESHOLD) {
+            rep_stosq(p, pattern, words);
+        }
+        else {
+            for (u64 i = 0; i < words; i++) {
+                ((u64*)p)[i] = pattern;
+            }
+        }
+
+        p += words*8;
+        n &= 7;
+    }
+
+    while (n--) {
+        *p++ = (u8)c;
+    }
+
+    return s;
+}
+
+// Fills `count` 32-bit values, for pixel spans. Two values go into each
+// 8 byte store, with an odd one at the front to align and at the back.
+MEM_FUNCTION void* memset32(void* s, u32 value, u64 count) {
+    u32* p = (u32*)s;
+
+    if (count > 0 && ((uintptr_t)p & 4)) {
+        *p++ = value;
+        count--;
+    }
+
+    u64 pattern = ((u64)value << 32) | value;
+    u64 pairs   = count / 2;
+    if (pairs * 8 >= MEM_REP_THRESHOLD) {
+        rep_stosq(p, pattern, pairs);
+    }
+    else {
+        for (u64 i = 0; i < pairs; i++) {
+            ((u64*)p)[i] = pattern;
+        }
+    }
+
+    if (count & 1) {
+        p[count-1] = value;
+    }
+
+    return s;
+}
+
+MEM_FUNCTION void* memmove(void* dest, const void* src, u64 n) {
+    u8* pdest = (u8*)dest;
+    const u8* psrc = (const u8*)src;
+
+    // A forward copy is safe whenever the destination starts below the
+    // source, every word is read before the store that could clobber it.
+    if (pdest <= psrc || pdest >= psrc + n) {
+        return memcpy(dest, src, n);
+    }
+
+    // Overlapping with dest above src, copy from the end. Backwards rep movs
+    // is slow on most cores, so this stays a word loop.
+    pdest += n;
+    psrc  += n;
+
+    if (n >= 8) {
+        u64 tail = (uintptr_t)pdest & 7;
+        n -= tail;
+        while (tail--) {
+            *--pdest = *--psrc;
+        }
+
+        u64 words = n / 8;
+        for (u64 i = 0; i < words; i++) {
+            pdest -= 8;
+            psrc  -= 8;
+            *(u64*)pdest = *(const unaligned_u64*)psrc;
+        }
+
+        n &= 7;
+    }
+
+    while (n--) {
+        *--pdest = *--psrc;
+    }
+
+    return dest;
+}
+
+MEM_FUNCTION int memcmp(const void* s1, const void* s2, u64 n) {
+    const u8* p1 = (const u8*)s1;
+    const u8* p2 = (const u8*)s2;
+
+    // Skip over equal words, the first differing word is then resolved a
+    // byte at a time so the result keeps memcmp's byte ordering.
+    while (n >= 8 && *(const unaligned_u64*)p1 == *(const unaligned_u64*)p2) {
+        p1 += 8;
+        p2 += 8;
+        n  -= 8;
+    }
+
+    for (u64 i = 0; i < n; i++) {
+        if (p1[i] != p2[i]) {
+            return p1[i] < p2[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Kernel memory primitives. The compiler emits calls to these for struct
+// copies and large initialisers, so they must keep their libc names.
+
+typedef struct {
+    bool erms; // rep movsb/stosb are fast for large sizes
+    bool fsrm; // rep movsb is also fast for short copies
+} MemFeatures;
+
+void        mem_init(void);
+MemFeatures mem_features(void);
+
+void* memcpy(void* dest, const void* src, u64 n);
+void* memset(void* s, int c, u64 n);
+void* memmove(void* dest, const void* src, u64 n);
+int   memcmp(const void* s1, const void* s2, u64 n);
+void* memset32(void* s, u32 value, u64 count);
@@ -0,0 +1,169 @@
+#include <util.h>
+#include <string.h>
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "vm.h"
+#include "arena.h"
+
+#define ARENA_HEADER_SIZE ((sizeof(ArenaBlock) + 15) & ~(u64)15)
+
+Context arena_ctx;
+static Arena context_arenas[3];
+
+static bool is_power_of_two(u64 num) {
+    return (num != 0) && (num & (num-1)) == 0;
+}
+
+static ArenaBlock* block_alloc(u64 size) {
+    u64 pages = (size + PAGE_SIZE-1) / PAGE_SIZE;
+    ArenaBlock* block = vm_reserve(pages, VMM_FLAG_WRITE);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->prev = NULL;
+    block->size = pages * PAGE_SIZE;
+    block->base_offset = 0;
+    return block;
+}
+
+static void block_free(ArenaBlock* block) {
+    vm_release(block);
+}
+
+void arena_init(Arena* arena, u64 block_size) {
+    arena->current = NULL;
+    arena->current_offset = 0;
+    arena->block_size = (block_size + PAGE_SIZE-1) & ~(u64)(PAGE_SIZE-1);
+}
+
+void arena_delete(Arena* arena) {
+    while (arena->current != NULL) {
+        ArenaBlock* prev = arena->current->prev;
+        block_free(arena->current);
+        arena->current = prev;
+    }
+
+    arena->current_offset = 0;
+}
+
+void* arena_alloc_aligned(Arena* arena, uintptr_t num_of_elem, uintptr_t elem_size, uintptr_t align_size) {
+    Assert(is_power_of_two(align_size));
+
+    uintptr_t allocation_size = num_of_elem * elem_size;
+    if (num_of_elem != 0 && allocation_size / num_of_elem != elem_size) {
+        return NULL;
+    }
+
+    ArenaBlock* block = arena->current;
+    uintptr_t cur_offset = 0;
+
+    if (block != NULL) {
+        cur_offset = (uintptr_t)block + arena->current_offset;
+        cur_offset += (~cur_offset+1) & (align_size-1);
+    }
+
+    if (block == NULL || cur_offset + allocation_size > (uintptr_t)block + block->size) {
+        // Chain a new block, big enough for this allocation if it is larger
+        // than the usual block size.
+        u64 needed = ARENA_HEADER_SIZE + allocation_size + align_size;
+        ArenaBlock* new_block = block_alloc(needed > arena->block_size ? needed : arena->block_size);
+        if (new_block == NULL) {
+            return NULL;
+        }
+
+        new_block->prev = block;
+        new_block->base_offset = (block != NULL) ? block->base_offset + block->size : 0;
+        arena->current = new_block;
+
+        cur_offset = (uintptr_t)new_block + ARENA_HEADER_SIZE;
+        cur_offset += (~cur_offset+1) & (align_size-1);
+    }
+
+    arena->current_offset = cur_offset + allocation_size - (uintptr_t)arena->current;
+    memset((void*)cur_offset, 0, allocation_size);
+
+    return (void*)cur_offset;
+}
+
+// Keeps the first block and drops the rest.
+void arena_reset(Arena* arena) {
+    if (arena->current == NULL) {
+        return;
+    }
+
+    while (arena->current->prev != NULL) {
+        ArenaBlock* prev = arena->current->prev;
+        block_free(arena->current);
+        arena->current = prev;
+    }
+
+    arena->current_offset = ARENA_HEADER_SIZE;
+}
+
+u64 arena_position(Arena* arena) {
+    if (arena->current == NULL) {
+        return 0;
+    }
+
+    return arena->current->base_offset + arena->current_offset;
+}
+
+Temp temp_begin(Arena* arena) {
+    Temp temp_arena = { arena, arena_position(arena) };
+    return temp_arena;
+}
+
+void temp_end(Temp temp) {
+    Arena* arena = temp.arena;
+
+    while (arena->current != NULL && arena->current->base_offset >= temp.original_offset &&
+            arena->current->prev != NULL)
+    {
+        ArenaBlock* prev = arena->current->prev;
+        block_free(arena->current);
+        arena->current = prev;
+    }
+
+    if (arena->current == NULL) {
+        return;
+    }
+
+    u64 offset = temp.original_offset - arena->current->base_offset;
+    arena->current_offset = offset < ARENA_HEADER_SIZE ? ARENA_HEADER_SIZE : offset;
+}
+
+void arena_context_init(u64 global_block_size, u64 scratch_block_size) {
+    arena_ctx.global_arena = &context_arenas[0];
+    arena_init(arena_ctx.global_arena, global_block_size);
+
+    for (u32 i = 0; i < ArrayCount(arena_ctx.scratch_pool); i++) {
+        arena_ctx.scratch_pool[i] = &context_arenas[i+1];
+        arena_init(arena_ctx.scratch_pool[i], scratch_block_size);
+    }
+}
+
+Temp scratch_get_free(Arena** arena_pool, int arena_pool_num, Arena** conflicting_arenas, int conflicting_num) {
+    for (int i = 0; i < arena_pool_num; i++) {
+        bool is_conflicting_arena = false;
+        for (int x = 0; x < conflicting_num; x++) {
+            if (arena_pool[i] == conflicting_arenas[x]) {
+                is_conflicting_arena = true;
+                break;
+            }
+        }
+
+        if (!is_conflicting_arena) {
+            return temp_begin(arena_pool[i]);
+        }
+    }
+
+    panic(strlit("arena: every scratch arena conflicts"));
+    return (Temp) { NULL, 0 };
+}
+
+void scratch_end(Temp temp_scratch) {
+    temp_end(temp_scratch);
+}
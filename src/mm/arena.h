@@ -0,0 +1,49 @@
+#pragma once
+
+// Kernel port of the metagen arena. The arena chains blocks so it grows on
+// demand and allocation stays a pointer bump. Like the mmap reservation in
+// metagen, a block is only reserved address space (mm/vm.h) and a page is
+// backed on first touch. Positions are absolute across the chain,
+// temp_end() hands back every block pushed since temp_begin(). Needs
+// vm_init().
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* prev;
+    u64 size;        // Bytes in this block, header included
+    u64 base_offset; // Absolute arena position of the start of this block
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* current;
+    u64 current_offset; // Offset into the current block
+    u64 block_size;
+} Arena;
+
+typedef struct {
+    Arena* arena;
+    u64 original_offset;
+} Temp;
+
+typedef struct {
+    Arena* global_arena;
+    Arena* scratch_pool[2];
+} Context;
+
+extern Context arena_ctx;
+
+void  arena_init(Arena* arena, u64 block_size);
+void  arena_delete(Arena* arena);
+void* arena_alloc_aligned(Arena* arena, uintptr_t num_of_elem, uintptr_t elem_size, uintptr_t align_size);
+void  arena_reset(Arena* arena);
+u64   arena_position(Arena* arena);
+Temp  temp_begin(Arena* arena);
+void  temp_end(Temp temp);
+void  arena_context_init(u64 global_block_size, u64 scratch_block_size);
+Temp  scratch_get_free(Arena** arena_pool, int arena_pool_size, Arena** conflicting_arenas, int conflicting_num);
+void  scratch_end(Temp temp_scratch);
+
+#define push_array_align(arena, type, num, align) (type*)arena_alloc_aligned(arena, (num), sizeof(type), align)
+#define push_array(arena, type, num) (type*)arena_alloc_aligned(arena, (num), sizeof(type), _Alignof(type))
+#define push_string(arena, num) (char*)arena_alloc_aligned(arena, (num), sizeof(char), _Alignof(char))
+#define push_struct(arena, type) (type*)arena_alloc_aligned(arena, 1, sizeof(type), _Alignof(type))
+#define get_scratch(conflicting_arenas, num) scratch_get_free(arena_ctx.scratch_pool, 2, conflicting_arenas, num)
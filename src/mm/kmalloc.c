@@ -0,0 +1,376 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "drivers/serial.h"
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+#include "slab.h"
+#include "kmalloc.h"
+
+#define KMALLOC_MAGIC       0x4B4D414Cu // "LAMK"
+#define KMALLOC_MAGIC_FREE  0x45455246u // "FREE", only written with KMALLOC_DEBUG
+#define KMALLOC_CLASS_LARGE 0xFFFFFFFFu
+
+#ifdef KMALLOC_DEBUG
+#define KMALLOC_TRAILER KMALLOC_REDZONE
+#else
+#define KMALLOC_TRAILER 0
+#endif
+
+// In front of every block. The slab free list reuses the first word of a
+// free object, which lands on `magic`, so a stale pointer fails the check.
+typedef struct {
+    u32 magic;
+    u32 class;
+    u64 size; // As requested
+} KmallocHeader;
+
+_Static_assert(sizeof(KmallocHeader) % SLAB_MIN_ALIGN == 0, "blocks stay SLAB_MIN_ALIGN aligned");
+_Static_assert(sizeof(KmallocHeader) < KMALLOC_MIN_SIZE, "the smallest class has room for a byte");
+
+typedef struct Magazine {
+    struct Magazine* next; // Depot lists
+    u32              count;
+    void*            objects[KMALLOC_MAGAZINE_SIZE];
+} Magazine;
+
+// A CPU's two magazines for one class. Each is either NULL, full or empty
+// except `loaded`, the one objects are taken from and returned to, so a CPU
+// flipping between allocating and freeing around a magazine boundary only
+// swaps the two instead of going to the depot.
+typedef struct {
+    Magazine* loaded;
+    Magazine* previous;
+} MagazinePair;
+
+typedef struct {
+    MagazinePair classes[KMALLOC_CLASSES];
+    u64          hits;   // Served by a magazine
+    u64          misses; // Had to go to the slab layer
+    u64          large;
+} __attribute__((aligned(64))) KmallocCpu;
+
+typedef struct {
+    SlabCache* cache;
+    Spinlock   lock;
+    Magazine*  full;
+    Magazine*  empty;
+    u32        full_count;
+    u32        empty_count;
+} Depot;
+
+static const String class_names[KMALLOC_CLASSES] = {
+    strlit("kmalloc-32"),  strlit("kmalloc-64"),  strlit("kmalloc-128"),
+    strlit("kmalloc-256"), strlit("kmalloc-512"), strlit("kmalloc-1024"),
+    strlit("kmalloc-2048")
+};
+
+// Only touched by their own CPU with interrupts off, hence no lock.
+static KmallocCpu cpu_caches[MAX_CPUS];
+static Depot      depots[KMALLOC_CLASSES];
+static SlabCache* magazine_cache;
+
+void kmalloc_init(void) {
+    magazine_cache = slab_cache_create(strlit("kmalloc-magazine"), sizeof(Magazine), NULL);
+    if (magazine_cache == NULL) {
+        panic(strlit("kmalloc: out of memory creating the magazine cache"));
+    }
+
+    for (u32 i = 0; i < KMALLOC_CLASSES; i++) {
+        depots[i].cache = slab_cache_create(class_names[i], KMALLOC_MIN_SIZE << i, NULL);
+        if (depots[i].cache == NULL) {
+            panic(strlit("kmalloc: out of memory creating the size classes"));
+        }
+    }
+}
+
+static u32 class_for(u64 total) {
+    u32 class = 0;
+    while (((u64)KMALLOC_MIN_SIZE << class) < total) {
+        class++;
+    }
+
+    return class;
+}
+
+static Magazine* depot_take_full(Depot* depot) {
+    spin_lock(&depot->lock);
+    Magazine* magazine = depot->full;
+    if (magazine != NULL) {
+        depot->full = magazine->next;
+        depot->full_count--;
+    }
+    spin_unlock(&depot->lock);
+
+    return magazine;
+}
+
+static void depot_put_empty(Depot* depot, Magazine* magazine) {
+    spin_lock(&depot->lock);
+    magazine->next = depot->empty;
+    depot->empty   = magazine;
+    depot->empty_count++;
+    spin_unlock(&depot->lock);
+}
+
+// Falls back to a new magazine, NULL only if that fails too.
+static Magazine* depot_take_empty(Depot* depot) {
+    spin_lock(&depot->lock);
+    Magazine* magazine = depot->empty;
+    if (magazine != NULL) {
+        depot->empty = magazine->next;
+        depot->empty_count--;
+    }
+    spin_unlock(&depot->lock);
+
+    if (magazine == NULL) {
+        magazine = slab_alloc(magazine_cache);
+        if (magazine != NULL) {
+            magazine->count = 0;
+        }
+    }
+
+    return magazine;
+}
+
+// Beyond KMALLOC_DEPOT_MAX full magazines the objects go back to their
+// slabs, so memory a burst of frees left behind can be reclaimed.
+static void depot_put_full(Depot* depot, Magazine* magazine) {
+    spin_lock(&depot->lock);
+    bool keep = depot->full_count < KMALLOC_DEPOT_MAX;
+    if (keep) {
+        magazine->next = depot->full;
+        depot->full    = magazine;
+        depot->full_count++;
+    }
+    spin_unlock(&depot->lock);
+
+    if (!keep) {
+        for (u32 i = 0; i < magazine->count; i++) {
+            slab_free(depot->cache, magazine->objects[i]);
+        }
+
+        magazine->count = 0;
+        depot_put_empty(depot, magazine);
+    }
+}
+
+static void* class_alloc(u32 class) {
+    u64 flags = interrupts_save();
+    KmallocCpu*   cpu   = &cpu_caches[this_cpu()->cpu_id];
+    MagazinePair* pair  = &cpu->classes[class];
+    Depot*        depot = &depots[class];
+
+    for (;;) {
+        if (pair->loaded != NULL && pair->loaded->count > 0) {
+            void* object = pair->loaded->objects[--pair->loaded->count];
+            cpu->hits++;
+            interrupts_restore(flags);
+            return object;
+        }
+
+        if (pair->previous != NULL && pair->previous->count > 0) {
+            Magazine* swap = pair->loaded;
+            pair->loaded   = pair->previous;
+            pair->previous = swap;
+            continue;
+        }
+
+        // Both empty: trade one for a full magazine from the depot.
+        Magazine* full = depot_take_full(depot);
+        if (full == NULL) {
+            break;
+        }
+
+        if (pair->previous != NULL) {
+            depot_put_empty(depot, pair->previous);
+        }
+
+        pair->previous = pair->loaded;
+        pair->loaded   = full;
+    }
+
+    cpu->misses++;
+    interrupts_restore(flags);
+    return slab_alloc(depot->cache);
+}
+
+static void class_free(u32 class, void* object) {
+    u64 flags = interrupts_save();
+    MagazinePair* pair  = &cpu_caches[this_cpu()->cpu_id].classes[class];
+    Depot*        depot = &depots[class];
+
+    for (;;) {
+        if (pair->loaded != NULL && pair->loaded->count < KMALLOC_MAGAZINE_SIZE) {
+            pair->loaded->objects[pair->loaded->count++] = object;
+            interrupts_restore(flags);
+            return;
+        }
+
+        if (pair->previous != NULL && pair->previous->count == 0) {
+            Magazine* swap = pair->loaded;
+            pair->loaded   = pair->previous;
+            pair->previous = swap;
+            continue;
+        }
+
+        // Both full: trade one for an empty magazine.
+        Magazine* empty = depot_take_empty(depot);
+        if (empty == NULL) {
+            break;
+        }
+
+        if (pair->previous != NULL) {
+            depot_put_full(depot, pair->previous);
+        }
+
+        pair->previous = pair->loaded;
+        pair->loaded   = empty;
+    }
+
+    interrupts_restore(flags);
+    slab_free(depot->cache, object);
+}
+
+#ifdef KMALLOC_DEBUG
+static void check_bytes(const u8* bytes, u64 count, u8 value, String what) {
+    for (u64 i = 0; i < count; i++) {
+        if (bytes[i] != value) {
+            print_log(strlit("kmalloc: "));
+            print_log(what);
+            print_log(strlit(" at "));
+            print_log_hex((u64)(bytes + i));
+            print_log(strlit("\n"));
+            panic(strlit("kmalloc: heap corruption"));
+        }
+    }
+}
+#endif
+
+void* kmalloc(u64 size) {
+    // Also keeps `total` from overflowing, pmm_alloc_pages() refuses the rest.
+    if (size == 0 || size > ((u64)PAGE_SIZE << PMM_MAX_ORDER)) {
+        return NULL;
+    }
+
+    u64 total = sizeof(KmallocHeader) + size + KMALLOC_TRAILER;
+    KmallocHeader* header;
+
+    if (total <= KMALLOC_MAX_SMALL) {
+        u32 class = class_for(total);
+        header = class_alloc(class);
+        if (header == NULL) {
+            return NULL;
+        }
+
+#ifdef KMALLOC_DEBUG
+        // Still poisoned from kfree() unless the slab layer had it since.
+        if (header->magic == KMALLOC_MAGIC_FREE) {
+            u64 body = ((u64)KMALLOC_MIN_SIZE << class) - sizeof(KmallocHeader);
+            check_bytes((u8*)(header + 1), body, KMALLOC_POISON_FREE, strlit("write after free"));
+        }
+#endif
+        header->class = class;
+    }
+    else {
+        u64 phys = pmm_alloc_pages((total + PAGE_SIZE-1) / PAGE_SIZE);
+        if (phys == 0) {
+            return NULL;
+        }
+
+        header = phys_to_virt(phys);
+        header->class = KMALLOC_CLASS_LARGE;
+        cpu_caches[this_cpu()->cpu_id].large++;
+    }
+
+    header->magic = KMALLOC_MAGIC;
+    header->size  = size;
+
+#ifdef KMALLOC_DEBUG
+    memset(header + 1, KMALLOC_POISON_ALLOC, size);
+    memset((u8*)(header + 1) + size, KMALLOC_POISON_REDZONE, KMALLOC_REDZONE);
+#endif
+    return header + 1;
+}
+
+void* kzalloc(u64 size) {
+    void* pointer = kmalloc(size);
+    if (pointer != NULL) {
+        memset(pointer, 0, size);
+    }
+
+    return pointer;
+}
+
+void kfree(void* pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+
+    KmallocHeader* header = (KmallocHeader*)pointer - 1;
+    if (header->magic != KMALLOC_MAGIC) {
+        print_log(strlit("kfree: "));
+        print_log_hex((u64)pointer);
+        print_log(strlit("\n"));
+        panic(strlit("kfree: not a kmalloc block or freed twice"));
+    }
+
+    u64 size  = header->size;
+    u32 class = header->class;
+
+#ifdef KMALLOC_DEBUG
+    check_bytes((u8*)pointer + size, KMALLOC_REDZONE, KMALLOC_POISON_REDZONE, strlit("overflow past the end"));
+#endif
+
+    if (class == KMALLOC_CLASS_LARGE) {
+        header->magic = 0;
+        u64 total = sizeof(KmallocHeader) + size + KMALLOC_TRAILER;
+        pmm_free_pages(virt_to_phys(header), (total + PAGE_SIZE-1) / PAGE_SIZE);
+        return;
+    }
+
+#ifdef KMALLOC_DEBUG
+    header->magic = KMALLOC_MAGIC_FREE;
+    memset(pointer, KMALLOC_POISON_FREE, ((u64)KMALLOC_MIN_SIZE << class) - sizeof(KmallocHeader));
+#else
+    header->magic = 0;
+#endif
+    class_free(class, header);
+}
+
+void kmalloc_print_stats(void) {
+    u64 hits   = 0;
+    u64 misses = 0;
+    u64 large  = 0;
+    for (u32 i = 0; i < percpu_count(); i++) {
+        hits   += cpu_caches[i].hits;
+        misses += cpu_caches[i].misses;
+        large  += cpu_caches[i].large;
+    }
+
+    print_log(strlit("kmalloc: magazine hits="));
+    print_log_u64(hits);
+    print_log(strlit(" misses="));
+    print_log_u64(misses);
+    print_log(strlit(" large="));
+    print_log_u64(large);
+#ifdef KMALLOC_DEBUG
+    print_log(strlit(" (debug: redzones, poisoning)"));
+#endif
+    print_log(strlit("\n"));
+
+    for (u32 i = 0; i < KMALLOC_CLASSES; i++) {
+        print_log(strlit("kmalloc: "));
+        print_log(class_names[i]);
+        print_log(strlit(" depot full="));
+        print_log_u64(depots[i].full_count);
+        print_log(strlit(" empty="));
+        print_log_u64(depots[i].empty_count);
+        print_log(strlit("\n"));
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// General purpose kernel heap. Sizes up to KMALLOC_MAX_SMALL come from
+// power of two slab caches with a magazine layer on top: every CPU keeps two
+// magazines (small stacks of free objects) per size class, so most calls
+// only disable interrupts and take no lock. Magazines are traded whole with
+// a per-class depot when both run full or empty, the slab layer is only
+// reached when the depot can't help. Anything larger is whole pages from the
+// page allocator.
+//
+// Every block starts with a small header that kfree() reads back, so
+// kfree() needs no size. Building with KMALLOC_DEBUG adds a redzone after
+// each block, fills fresh blocks with KMALLOC_POISON_ALLOC and freed ones
+// with KMALLOC_POISON_FREE, and checks all of it on the way through.
+
+#define KMALLOC_MIN_SIZE      32 // The header alone takes 16
+#define KMALLOC_CLASSES       7  // 32, 64, ... 2048
+#define KMALLOC_MAX_SMALL     (KMALLOC_MIN_SIZE << (KMALLOC_CLASSES - 1))
+#define KMALLOC_MAGAZINE_SIZE 32
+#define KMALLOC_DEPOT_MAX     16 // Full magazines a class keeps in reserve
+
+#define KMALLOC_REDZONE       16
+#define KMALLOC_POISON_ALLOC  0xA5
+#define KMALLOC_POISON_FREE   0x6B
+#define KMALLOC_POISON_REDZONE 0xCC
+
+void  kmalloc_init(void);
+void* kmalloc(u64 size);
+void* kzalloc(u64 size);
+void  kfree(void* pointer);
+void  kmalloc_print_stats(void);
@@ -0,0 +1,306 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+
+// Free blocks are kept on one doubly linked list per order, the list nodes
+// live inside the free memory itself (reached through the HHDM), so the only
+// side storage is one PageInfo per frame.
+
+typedef struct FreeBlock {
+    struct FreeBlock* next;
+    struct FreeBlock* prev;
+} FreeBlock;
+
+#define PAGE_FLAG_FREE (1 << 0) // Frame heads a free block of `order`
+
+typedef struct {
+    u8  order;
+    u8  flags;
+    u16 shares; // Extra mappings of a single allocated frame, see pmm_page_share()
+} PageInfo;
+
+typedef struct {
+    FreeBlock* free_lists[PMM_MAX_ORDER+1];
+    u64        free_counts[PMM_MAX_ORDER+1];
+    PageInfo*  pages;
+    u64        page_count;   // Frames covered by `pages`, up to the highest usable one
+    u64        usable_pages; // Frames that were ever handed to the allocator
+    u64        free_pages;
+    McsLock    lock;         // Irqsave, the page fault path allocates too
+} PhysicalMemory;
+
+u64 hhdm_offset;
+static PhysicalMemory pmm;
+
+static inline u64 block_pages(u32 order) {
+    return (u64)1 << order;
+}
+
+static void free_list_push(u64 pfn, u32 order) {
+    FreeBlock* block = phys_to_virt(pfn << PAGE_SHIFT);
+    block->prev = NULL;
+    block->next = pmm.free_lists[order];
+    if (block->next != NULL) {
+        block->next->prev = block;
+    }
+
+    pmm.free_lists[order] = block;
+    pmm.free_counts[order]++;
+    pmm.pages[pfn].order = order;
+    pmm.pages[pfn].flags |= PAGE_FLAG_FREE;
+}
+
+static void free_list_remove(u64 pfn, u32 order) {
+    FreeBlock* block = phys_to_virt(pfn << PAGE_SHIFT);
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    }
+    else {
+        pmm.free_lists[order] = block->next;
+    }
+
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+
+    pmm.free_counts[order]--;
+    pmm.pages[pfn].flags &= ~PAGE_FLAG_FREE;
+}
+
+// Gives a naturally aligned block back, merging it with its buddy for as
+// long as the buddy is free and of the same order.
+static void free_block(u64 pfn, u32 order) {
+    pmm.free_pages += block_pages(order);
+
+    while (order < PMM_MAX_ORDER) {
+        u64 buddy = pfn ^ block_pages(order);
+        if (buddy >= pmm.page_count ||
+                !(pmm.pages[buddy].flags & PAGE_FLAG_FREE) ||
+                pmm.pages[buddy].order != order)
+        {
+            break;
+        }
+
+        free_list_remove(buddy, order);
+        pfn &= ~block_pages(order);
+        order++;
+    }
+
+    free_list_push(pfn, order);
+}
+
+// Splits [pfn, pfn+count) into the largest naturally aligned blocks that fit
+// and frees each of them.
+static void free_range(u64 pfn, u64 count) {
+    while (count > 0) {
+        u32 order = 0;
+        while (order < PMM_MAX_ORDER &&
+                (pfn & block_pages(order)) == 0 &&
+                block_pages(order+1) <= count)
+        {
+            order++;
+        }
+
+        free_block(pfn, order);
+        pfn   += block_pages(order);
+        count -= block_pages(order);
+    }
+}
+
+static u64 alloc_block(u32 order) {
+    u32 current_order = order;
+    while (current_order <= PMM_MAX_ORDER && pmm.free_lists[current_order] == NULL) {
+        current_order++;
+    }
+
+    if (current_order > PMM_MAX_ORDER) {
+        return 0;
+    }
+
+    u64 pfn = virt_to_phys(pmm.free_lists[current_order]) >> PAGE_SHIFT;
+    free_list_remove(pfn, current_order);
+
+    // Hand the upper halves back until the block is the requested size.
+    while (current_order > order) {
+        current_order--;
+        free_list_push(pfn + block_pages(current_order), current_order);
+    }
+
+    pmm.pages[pfn].order = order;
+    pmm.free_pages -= block_pages(order);
+    return pfn;
+}
+
+void pmm_init(struct limine_memmap_response* memmap, u64 hhdm) {
+    hhdm_offset = hhdm;
+
+    u64 highest_address = 0;
+    for (u64 i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry* entry = memmap->entries[i];
+        if (entry->type == LIMINE_MEMMAP_USABLE && entry->base + entry->length > highest_address) {
+            highest_address = entry->base + entry->length;
+        }
+    }
+
+    pmm.page_count = highest_address >> PAGE_SHIFT;
+    u64 metadata_size = (pmm.page_count * sizeof(PageInfo) + PAGE_SIZE-1) & ~(u64)(PAGE_SIZE-1);
+
+    // Carve the PageInfo array out of the front of the first usable region
+    // big enough to hold it.
+    struct limine_memmap_entry* metadata_entry = NULL;
+    for (u64 i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry* entry = memmap->entries[i];
+        if (entry->type == LIMINE_MEMMAP_USABLE && entry->length >= metadata_size) {
+            metadata_entry = entry;
+            break;
+        }
+    }
+
+    if (metadata_entry == NULL) {
+        panic(strlit("pmm: no usable region large enough for the page metadata"));
+    }
+
+    pmm.pages = phys_to_virt(metadata_entry->base);
+    memset(pmm.pages, 0, metadata_size);
+
+    for (u64 i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry* entry = memmap->entries[i];
+        if (entry->type != LIMINE_MEMMAP_USABLE) {
+            continue;
+        }
+
+        u64 start = (entry->base + PAGE_SIZE-1) >> PAGE_SHIFT;
+        u64 end   = (entry->base + entry->length) >> PAGE_SHIFT;
+
+        if (entry == metadata_entry) {
+            start += metadata_size >> PAGE_SHIFT;
+        }
+
+        // Frame 0 doubles as the allocation failure value.
+        if (start == 0) {
+            start = 1;
+        }
+
+        if (start < end) {
+            pmm.usable_pages += end - start;
+            free_range(start, end - start);
+        }
+    }
+}
+
+u64 pmm_alloc_page(void) {
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    u64 pfn   = alloc_block(0);
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+    return pfn << PAGE_SHIFT;
+}
+
+u64 pmm_alloc_pages(u64 count) {
+    if (count == 0 || count > block_pages(PMM_MAX_ORDER)) {
+        return 0;
+    }
+
+    u32 order = 0;
+    while (block_pages(order) < count) {
+        order++;
+    }
+
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    u64 pfn   = alloc_block(order);
+
+    // Don't keep the rounding to a power of two, a 3 MiB back buffer would
+    // otherwise pin a whole 4 MiB block.
+    if (pfn != 0 && block_pages(order) > count) {
+        free_range(pfn + count, block_pages(order) - count);
+    }
+
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+    return pfn << PAGE_SHIFT;
+}
+
+void pmm_free_page(u64 phys) {
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    free_block(phys >> PAGE_SHIFT, 0);
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+}
+
+void pmm_free_pages(u64 phys, u64 count) {
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    free_range(phys >> PAGE_SHIFT, count);
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+}
+
+// Copy-on-write lets several mappings own one frame. Each extra owner is
+// counted here and pmm_page_release() only frees the frame once the last
+// one lets go.
+void pmm_page_share(u64 phys) {
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    PageInfo* page = &pmm.pages[phys >> PAGE_SHIFT];
+    Assert(page->shares != 0xFFFF);
+    page->shares++;
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+}
+
+bool pmm_page_shared(u64 phys) {
+    return __atomic_load_n(&pmm.pages[phys >> PAGE_SHIFT].shares, __ATOMIC_ACQUIRE) != 0;
+}
+
+void pmm_page_release(u64 phys) {
+    McsNode node;
+    u64 flags = mcs_lock_irqsave(&pmm.lock, &node);
+    PageInfo* page = &pmm.pages[phys >> PAGE_SHIFT];
+    if (page->shares != 0) {
+        page->shares--;
+    }
+    else {
+        free_block(phys >> PAGE_SHIFT, 0);
+    }
+    mcs_unlock_irqrestore(&pmm.lock, &node, flags);
+}
+
+u64 pmm_free_page_count(void) {
+    return pmm.free_pages;
+}
+
+u64 pmm_used_page_count(void) {
+    return pmm.usable_pages - pmm.free_pages;
+}
+
+void pmm_print_stats(void) {
+    print_log(strlit("pmm: free="));
+    print_log_u64(pmm.free_pages);
+    print_log(strlit(" used="));
+    print_log_u64(pmm_used_page_count());
+    print_log(strlit(" total="));
+    print_log_u64(pmm.usable_pages);
+    print_log(strlit(" pages ("));
+    print_log_u64((pmm.free_pages * PAGE_SIZE) / KB(1));
+    print_log(strlit(" KiB free)\n"));
+
+    // Free blocks per order, low orders filling up while the high ones drain
+    // is what fragmentation looks like.
+    u32 largest_order = 0;
+    print_log(strlit("pmm: free blocks by order:"));
+    for (u32 order = 0; order <= PMM_MAX_ORDER; order++) {
+        print_log(strlit(" "));
+        print_log_u64(pmm.free_counts[order]);
+        if (pmm.free_counts[order] != 0) {
+            largest_order = order;
+        }
+    }
+
+    print_log(strlit("\npmm: largest free block="));
+    print_log_u64(pmm.free_counts[largest_order] != 0 ? block_pages(largest_order) : 0);
+    print_log(strlit(" pages\n"));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Physical page frame allocator. A binary buddy allocator built from the
+// Limine memory map: single pages and contiguous runs of up to
+// 2^PMM_MAX_ORDER pages are handed out in O(log n). Addresses going in and
+// out are physical, use phys_to_virt() to touch the memory.
+
+struct limine_memmap_response;
+
+#define PAGE_SIZE     4096
+#define PAGE_SHIFT    12
+#define PMM_MAX_ORDER 10
+
+extern u64 hhdm_offset;
+
+static inline void* phys_to_virt(u64 phys) {
+    return (void*)(phys + hhdm_offset);
+}
+
+static inline u64 virt_to_phys(void* virt) {
+    return (u64)virt - hhdm_offset;
+}
+
+void pmm_init(struct limine_memmap_response* memmap, u64 hhdm);
+u64  pmm_alloc_page(void);
+u64  pmm_alloc_pages(u64 count);
+void pmm_free_page(u64 phys);
+void pmm_free_pages(u64 phys, u64 count);
+void pmm_page_share(u64 phys);
+bool pmm_page_shared(u64 phys);
+void pmm_page_release(u64 phys);
+u64  pmm_free_page_count(void);
+u64  pmm_used_page_count(void);
+void pmm_print_stats(void);
@@ -0,0 +1,228 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+#include "slab.h"
+
+// Slabs grow (in powers of two pages) until header plus tail waste is at
+// most 1/SLAB_MAX_WASTE_RATIO of the slab, but never past SLAB_MAX_PAGES.
+#define SLAB_MAX_PAGES       8
+#define SLAB_MAX_WASTE_RATIO 8
+
+#define SIZE_CLASS_COUNT 9 // 16, 32, ... 4096
+
+// Caches are objects too, they come out of this statically set up cache.
+static SlabCache  cache_cache;
+static SlabCache* caches;
+static Spinlock   caches_lock;
+static SlabCache* size_caches[SIZE_CLASS_COUNT];
+
+static const String size_cache_names[SIZE_CLASS_COUNT] = {
+    strlit("size-16"),  strlit("size-32"),  strlit("size-64"),
+    strlit("size-128"), strlit("size-256"), strlit("size-512"),
+    strlit("size-1024"), strlit("size-2048"), strlit("size-4096")
+};
+
+static void list_push(Slab** list, Slab* slab) {
+    slab->prev = NULL;
+    slab->next = *list;
+    if (*list != NULL) {
+        (*list)->prev = slab;
+    }
+
+    *list = slab;
+}
+
+static void list_remove(Slab** list, Slab* slab) {
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    }
+    else {
+        *list = slab->next;
+    }
+
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+}
+
+static void cache_setup(SlabCache* cache, String name, u64 object_size, SlabConstructor constructor) {
+    object_size = (object_size + SLAB_MIN_ALIGN-1) & ~(u64)(SLAB_MIN_ALIGN-1);
+    Assert(object_size <= SLAB_MAX_SIZE);
+
+    *cache = (SlabCache) {
+        .name          = name,
+        .object_size   = object_size,
+        .object_offset = (sizeof(Slab) + SLAB_MIN_ALIGN-1) & ~(u64)(SLAB_MIN_ALIGN-1),
+        .constructor   = constructor
+    };
+
+    for (cache->slab_pages = 1; cache->slab_pages < SLAB_MAX_PAGES; cache->slab_pages *= 2) {
+        u64 slab_size = cache->slab_pages * PAGE_SIZE;
+        u64 objects   = (slab_size - cache->object_offset) / object_size;
+        u64 waste     = slab_size - objects * object_size;
+        if (objects > 0 && waste * SLAB_MAX_WASTE_RATIO <= slab_size) {
+            break;
+        }
+    }
+
+    cache->objects_per_slab = (cache->slab_pages * PAGE_SIZE - cache->object_offset) / object_size;
+
+    u64 flags = spin_lock_irqsave(&caches_lock);
+    cache->next = caches;
+    caches = cache;
+    spin_unlock_irqrestore(&caches_lock, flags);
+}
+
+static Slab* slab_create(SlabCache* cache) {
+    // Power of two page counts come back naturally aligned from the buddy
+    // allocator, which is what lets slab_free() find the header by masking.
+    u64 phys = pmm_alloc_pages(cache->slab_pages);
+    if (phys == 0) {
+        return NULL;
+    }
+
+    Slab* slab = phys_to_virt(phys);
+    *slab = (Slab) { .cache = cache };
+
+    u8* object = (u8*)slab + cache->object_offset;
+    for (u32 i = 0; i < cache->objects_per_slab; i++) {
+        *(void**)object = slab->free_list;
+        slab->free_list = object;
+        object += cache->object_size;
+    }
+
+    cache->slab_count++;
+    return slab;
+}
+
+static void slab_destroy(Slab* slab) {
+    slab->cache->slab_count--;
+    pmm_free_pages(virt_to_phys(slab), slab->cache->slab_pages);
+}
+
+void slab_init(void) {
+    cache_setup(&cache_cache, strlit("slab-cache"), sizeof(SlabCache), NULL);
+
+    for (u32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+        size_caches[i] = slab_cache_create(size_cache_names[i], SLAB_MIN_SIZE << i, NULL);
+        if (size_caches[i] == NULL) {
+            panic(strlit("slab: out of memory creating the size caches"));
+        }
+    }
+}
+
+SlabCache* slab_cache_create(String name, u64 object_size, SlabConstructor constructor) {
+    SlabCache* cache = slab_alloc(&cache_cache);
+    if (cache != NULL) {
+        cache_setup(cache, name, object_size, constructor);
+    }
+
+    return cache;
+}
+
+SlabCache* slab_cache_for_size(u64 size) {
+    for (u32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+        if (size <= (u64)SLAB_MIN_SIZE << i) {
+            return size_caches[i];
+        }
+    }
+
+    return NULL;
+}
+
+void* slab_alloc(SlabCache* cache) {
+    u64 flags = spin_lock_irqsave(&cache->lock);
+
+    Slab* slab = cache->partial;
+    if (slab == NULL) {
+        slab = cache->empty;
+        if (slab != NULL) {
+            list_remove(&cache->empty, slab);
+        }
+        else {
+            slab = slab_create(cache);
+            if (slab == NULL) {
+                spin_unlock_irqrestore(&cache->lock, flags);
+                return NULL;
+            }
+        }
+
+        list_push(&cache->partial, slab);
+    }
+
+    void* object = slab->free_list;
+    slab->free_list = *(void**)object;
+    slab->in_use++;
+    cache->objects_in_use++;
+
+    if (slab->in_use == cache->objects_per_slab) {
+        list_remove(&cache->partial, slab);
+        list_push(&cache->full, slab);
+    }
+
+    spin_unlock_irqrestore(&cache->lock, flags);
+
+    if (cache->constructor != NULL) {
+        cache->constructor(object);
+    }
+
+    return object;
+}
+
+void slab_free(SlabCache* cache, void* object) {
+    Slab* slab = (Slab*)((u64)object & ~(cache->slab_pages*PAGE_SIZE - 1));
+    Assert(slab->cache == cache);
+
+    u64 flags = spin_lock_irqsave(&cache->lock);
+
+    if (slab->in_use == cache->objects_per_slab) {
+        list_remove(&cache->full, slab);
+        list_push(&cache->partial, slab);
+    }
+
+    *(void**)object = slab->free_list;
+    slab->free_list = object;
+    slab->in_use--;
+    cache->objects_in_use--;
+
+    // Keep one empty slab around so a cache sitting on a slab boundary
+    // doesn't bounce pages in and out of the page allocator.
+    if (slab->in_use == 0) {
+        list_remove(&cache->partial, slab);
+        if (cache->empty == NULL) {
+            list_push(&cache->empty, slab);
+        }
+        else {
+            slab_destroy(slab);
+        }
+    }
+
+    spin_unlock_irqrestore(&cache->lock, flags);
+}
+
+void slab_print_stats(void) {
+    for (SlabCache* cache = caches; cache != NULL; cache = cache->next) {
+        u64 slab_size = cache->slab_pages * PAGE_SIZE;
+        u64 capacity  = cache->slab_count * cache->objects_per_slab;
+        u64 overhead  = cache->slab_count * (slab_size - cache->objects_per_slab * cache->object_size);
+
+        print_log(strlit("slab: "));
+        print_log(cache->name);
+        print_log(strlit(" size="));
+        print_log_u64(cache->object_size);
+        print_log(strlit(" in_use="));
+        print_log_u64(cache->objects_in_use);
+        print_log(strlit(" free="));
+        print_log_u64(capacity - cache->objects_in_use);
+        print_log(strlit(" slabs="));
+        print_log_u64(cache->slab_count);
+        print_log(strlit(" wasted="));
+        print_log_u64(overhead);
+        print_log(strlit(" B\n"));
+    }
+}
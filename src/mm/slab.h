@@ -0,0 +1,50 @@
+#pragma once
+
+// Slab allocator for fixed-size kernel objects, sitting on top of the page
+// allocator. Each slab is a naturally aligned run of pages with a Slab
+// header at the front, found again by masking an object's address. Free
+// objects are chained through their own first word, so the only per-object
+// cost is rounding up to SLAB_MIN_ALIGN.
+//
+// The constructor runs on every allocation: the free-list link overwrites
+// the start of a free object, so constructed state can't survive a free.
+
+#define SLAB_MIN_SIZE  16
+#define SLAB_MAX_SIZE  4096
+#define SLAB_MIN_ALIGN 16
+
+typedef void (*SlabConstructor)(void* object);
+
+typedef struct Slab {
+    struct SlabCache* cache;
+    struct Slab*      next;
+    struct Slab*      prev;
+    void*             free_list;
+    u32               in_use;
+} Slab;
+
+typedef struct SlabCache {
+    String            name;
+    u64               object_size;
+    u64               object_offset; // Offset of the first object from the slab start
+    u64               slab_pages;
+    u32               objects_per_slab;
+    SlabConstructor   constructor;
+
+    Slab*             partial;
+    Slab*             full;
+    Slab*             empty;
+
+    u64               slab_count;
+    u64               objects_in_use;
+    Spinlock          lock;
+
+    struct SlabCache* next;
+} SlabCache;
+
+void       slab_init(void);
+SlabCache* slab_cache_create(String name, u64 object_size, SlabConstructor constructor);
+SlabCache* slab_cache_for_size(u64 size);
+void*      slab_alloc(SlabCache* cache);
+void       slab_free(SlabCache* cache, void* object);
+void       slab_print_stats(void);
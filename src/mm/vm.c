@@ -0,0 +1,359 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "cpu/smp.h"
+#include "drivers/serial.h"
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "slab.h"
+#include "vm.h"
+
+#define PF_ERROR_PRESENT (1 << 0) // Protection violation rather than a missing page
+#define PF_ERROR_WRITE   (1 << 1)
+
+// Regions are kept in a list sorted by address. The lock is irqsave, it is
+// taken in the page fault handler, and is always taken before vmm_lock.
+static VmRegion*  regions;
+static Spinlock   regions_lock;
+static SlabCache* region_cache;
+static VmStats    stats;
+
+static u64      zero_pool[VM_ZERO_POOL_SIZE];
+static u32      zero_pool_count;
+static Spinlock zero_pool_lock;
+
+static VmRegion* find_region(u64 address) {
+    for (VmRegion* region = regions; region != NULL && region->base <= address; region = region->next) {
+        if (address < region->base + region->pages * PAGE_SIZE) {
+            return region;
+        }
+    }
+
+    return NULL;
+}
+
+static void insert_region(VmRegion* region) {
+    VmRegion** link = &regions;
+    while (*link != NULL && (*link)->base < region->base) {
+        link = &(*link)->next;
+    }
+
+    region->next = *link;
+    *link = region;
+}
+
+static void remove_region(VmRegion* region) {
+    VmRegion** link = &regions;
+    while (*link != region) {
+        link = &(*link)->next;
+    }
+
+    *link = region->next;
+}
+
+static u64 zero_page_get(void) {
+    u64 flags = spin_lock_irqsave(&zero_pool_lock);
+    u64 phys  = zero_pool_count > 0 ? zero_pool[--zero_pool_count] : 0;
+    spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+    if (phys != 0) {
+        stats.zero_pool_hits++;
+        return phys;
+    }
+
+    stats.zero_pool_misses++;
+    phys = pmm_alloc_page();
+    if (phys != 0) {
+        memset(phys_to_virt(phys), 0, PAGE_SIZE);
+    }
+
+    return phys;
+}
+
+// Called by idle CPUs between naps. Clears at most VM_REFILL_BATCH pages so
+// that work arriving meanwhile doesn't wait long. Pages are cleared outside
+// the lock and handed back if the pool filled up in the meantime.
+void vm_idle_refill(void) {
+    for (u32 i = 0; i < VM_REFILL_BATCH && __atomic_load_n(&zero_pool_count, __ATOMIC_RELAXED) < VM_ZERO_POOL_SIZE; i++) {
+        u64 phys = pmm_alloc_page();
+        if (phys == 0) {
+            return;
+        }
+
+        memset(phys_to_virt(phys), 0, PAGE_SIZE);
+
+        u64  flags  = spin_lock_irqsave(&zero_pool_lock);
+        bool stored = zero_pool_count < VM_ZERO_POOL_SIZE;
+        if (stored) {
+            zero_pool[zero_pool_count++] = phys;
+        }
+        spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+        if (!stored) {
+            pmm_free_page(phys);
+            return;
+        }
+
+        __atomic_add_fetch(&stats.pages_zeroed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Resolves a fault on `page`, returns false if it isn't ours to fix. A
+// share that was broken leaves stale read-only entries on other CPUs,
+// `batch` collects them for the caller to flush once the lock is dropped.
+// Until then those CPUs can still read the old frame, so its reference is
+// handed back in `release` instead of dropped here.
+static bool resolve_fault(u64 page, u64 error_code, TlbBatch* batch, u64* release) {
+    VmRegion* region = find_region(page);
+    if (region == NULL) {
+        return false;
+    }
+
+    u64 phys;
+    u32 flags;
+    if (!vmm_query(page, &phys, &flags)) {
+        u64 fresh = zero_page_get();
+        if (fresh == 0) {
+            print_log(strlit("vm: out of memory faulting in a page\n"));
+            return false;
+        }
+
+        if (!vmm_map(page, fresh, 1, region->flags, NULL)) {
+            pmm_free_page(fresh);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Another CPU got here first, or this one still held an old entry.
+    if (!(error_code & PF_ERROR_PRESENT) || ((error_code & PF_ERROR_WRITE) && (flags & VMM_FLAG_WRITE))) {
+        invlpg(page);
+        return true;
+    }
+
+    if (!(error_code & PF_ERROR_WRITE) || !(flags & VMM_FLAG_COW) || !(region->flags & VMM_FLAG_WRITE)) {
+        return false;
+    }
+
+    if (!pmm_page_shared(phys)) {
+        // The other sharers are gone, the frame is ours again. Other CPUs
+        // can at worst fault once more on their read-only entry, so only
+        // the local TLB is flushed.
+        TlbBatch stale = {};
+        if (!vmm_map(page, phys, 1, region->flags, &stale)) {
+            return false;
+        }
+
+        invlpg(page);
+        stats.cow_reuses++;
+        return true;
+    }
+
+    u64 copy = pmm_alloc_page();
+    if (copy == 0) {
+        print_log(strlit("vm: out of memory breaking a copy-on-write share\n"));
+        return false;
+    }
+
+    memcpy(phys_to_virt(copy), phys_to_virt(phys), PAGE_SIZE);
+    if (!vmm_map(page, copy, 1, region->flags, batch)) {
+        pmm_free_page(copy);
+        return false;
+    }
+
+    *release = phys;
+    stats.cow_copies++;
+    return true;
+}
+
+// Copying a shared page leaves other CPUs with entries for the old frame,
+// which keeps its reference until the shootdown that removes them is done.
+// The shootdown needs interrupts on. They are turned back
+// on for it if the faulting code had them on, otherwise that is only fine
+// while this is the only CPU running.
+static void page_fault(InterruptFrame* frame) {
+    u64      page      = read_cr2() & ~(u64)(PAGE_SIZE-1);
+    bool     irqs_were = (frame->rflags & RFLAGS_IF) != 0;
+    TlbBatch batch     = {};
+    u64      release   = 0;
+
+    __atomic_add_fetch(&stats.faults, 1, __ATOMIC_RELAXED);
+
+    u64  flags    = spin_lock_irqsave(&regions_lock);
+    bool resolved = resolve_fault(page, frame->error_code, &batch, &release);
+    spin_unlock_irqrestore(&regions_lock, flags);
+
+    if (!resolved) {
+        unhandled_exception(frame);
+    }
+
+    if (batch.count != 0 || batch.full_flush) {
+        if (!irqs_were && smp_online_count() > 1) {
+            panic(strlit("vm: copy-on-write fault with interrupts disabled"));
+        }
+
+        interrupts_restore(frame->rflags);
+        tlb_batch_flush(&batch);
+        interrupts_disable();
+    }
+
+    if (release != 0) {
+        pmm_page_release(release);
+    }
+}
+
+void vm_init(void) {
+    region_cache = slab_cache_create(strlit("vm_region"), sizeof(VmRegion), NULL);
+    if (region_cache == NULL) {
+        panic(strlit("vm: out of memory creating the region cache"));
+    }
+
+    interrupt_register(VECTOR_PAGE_FAULT, page_fault);
+}
+
+void* vm_reserve(u64 pages, u32 flags) {
+    if (pages == 0) {
+        return NULL;
+    }
+
+    VmRegion* region = slab_alloc(region_cache);
+    if (region == NULL) {
+        return NULL;
+    }
+
+    *region = (VmRegion) {
+        .base  = vmm_reserve(pages),
+        .pages = pages,
+        .flags = flags & ~VMM_FLAG_COW
+    };
+
+    u64 irq_flags = spin_lock_irqsave(&regions_lock);
+    insert_region(region);
+    spin_unlock_irqrestore(&regions_lock, irq_flags);
+
+    return (void*)region->base;
+}
+
+// Pages the source never touched stay lazy on both sides. Must not race
+// with writes to the source, they may land in the shared frame until the
+// flush at the end has gone through. Needs interrupts enabled.
+void* vm_duplicate(void* base) {
+    VmRegion* copy = slab_alloc(region_cache);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    TlbBatch batch = {};
+    u64 irq_flags  = spin_lock_irqsave(&regions_lock);
+
+    VmRegion* source = find_region((u64)base);
+    if (source == NULL || source->base != (u64)base) {
+        spin_unlock_irqrestore(&regions_lock, irq_flags);
+        slab_free(region_cache, copy);
+        return NULL;
+    }
+
+    *copy = (VmRegion) {
+        .base  = vmm_reserve(source->pages),
+        .pages = source->pages,
+        .flags = source->flags
+    };
+
+    u32 shared_flags = (source->flags & ~VMM_FLAG_WRITE) | VMM_FLAG_COW;
+    bool ok = true;
+
+    for (u64 i = 0; i < source->pages && ok; i++) {
+        u64 phys;
+        u32 flags;
+        if (!vmm_query(source->base + i*PAGE_SIZE, &phys, &flags)) {
+            continue;
+        }
+
+        if (flags & VMM_FLAG_WRITE) {
+            ok = vmm_map(source->base + i*PAGE_SIZE, phys, 1, shared_flags, &batch);
+        }
+
+        if (ok) {
+            ok = vmm_map(copy->base + i*PAGE_SIZE, phys, 1, shared_flags, &batch);
+        }
+
+        if (ok) {
+            pmm_page_share(phys);
+        }
+    }
+
+    // A partial copy is still a valid region, release it below.
+    insert_region(copy);
+    spin_unlock_irqrestore(&regions_lock, irq_flags);
+    tlb_batch_flush(&batch);
+
+    if (!ok) {
+        vm_release((void*)copy->base);
+        return NULL;
+    }
+
+    return (void*)copy->base;
+}
+
+// Unmaps the whole region and drops its frames, shared ones only go back
+// to the allocator with their last mapping. Frames are released in batches
+// and only after the TLBs no longer reach them. Needs interrupts enabled.
+void vm_release(void* base) {
+    u64 irq_flags = spin_lock_irqsave(&regions_lock);
+    VmRegion* region = find_region((u64)base);
+    if (region == NULL || region->base != (u64)base) {
+        spin_unlock_irqrestore(&regions_lock, irq_flags);
+        return;
+    }
+
+    remove_region(region);
+    spin_unlock_irqrestore(&regions_lock, irq_flags);
+
+    // Nothing can fault pages into the range any more, it's ours alone.
+    u64      frames[TLB_BATCH_MAX_ENTRIES];
+    u32      frame_count = 0;
+    TlbBatch batch       = {};
+
+    for (u64 i = 0; i < region->pages; i++) {
+        u64 virt = region->base + i*PAGE_SIZE;
+        u64 phys;
+        u32 flags;
+        if (vmm_query(virt, &phys, &flags)) {
+            vmm_unmap(virt, 1, &batch);
+            frames[frame_count++] = phys;
+        }
+
+        if (frame_count == TLB_BATCH_MAX_ENTRIES || (i + 1 == region->pages && frame_count > 0)) {
+            tlb_batch_flush(&batch);
+            for (u32 f = 0; f < frame_count; f++) {
+                pmm_page_release(frames[f]);
+            }
+            frame_count = 0;
+        }
+    }
+
+    slab_free(region_cache, region);
+}
+
+void vm_print_stats(void) {
+    print_log(strlit("vm: faults="));
+    print_log_u64(stats.faults);
+    print_log(strlit(" zero_pool_hits="));
+    print_log_u64(stats.zero_pool_hits);
+    print_log(strlit(" zero_pool_misses="));
+    print_log_u64(stats.zero_pool_misses);
+    print_log(strlit(" cow_copies="));
+    print_log_u64(stats.cow_copies);
+    print_log(strlit(" cow_reuses="));
+    print_log_u64(stats.cow_reuses);
+    print_log(strlit(" pages_zeroed="));
+    print_log_u64(stats.pages_zeroed);
+    print_log(strlit(" pool="));
+    print_log_u64(zero_pool_count);
+    print_log(strlit("\n"));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Demand-paged regions of kernel address space. vm_reserve() only sets a
+// range aside, each page gets a frame on first touch through the page fault
+// handler. Reads and writes alike fault in a zeroed page, taken from a pool
+// that idle CPUs keep topped up (vm_idle_refill()) so the fault path
+// rarely has to clear memory itself.
+//
+// vm_duplicate() makes a copy-on-write twin of a region: both sides map the
+// same frames read-only and a write fault gives the writer a private copy,
+// or simply makes the page writable again once nobody else shares the
+// frame. Breaking a share flushes other CPUs' TLBs, so writes to duplicated
+// regions need interrupts enabled. Faulting in fresh pages works anywhere.
+//
+// Address space is never reused, released ranges stay unmapped. Needs the
+// slab allocator.
+
+#define VM_ZERO_POOL_SIZE   64 // Pre-zeroed frames kept in reserve
+#define VM_REFILL_BATCH     8  // Frames cleared per vm_idle_refill() call
+
+typedef struct VmRegion {
+    u64              base;
+    u64              pages;
+    u32              flags; // VMM_FLAG_*, applied once a page is writable
+    struct VmRegion* next;
+} VmRegion;
+
+typedef struct {
+    u64 faults;
+    u64 zero_pool_hits;
+    u64 zero_pool_misses;
+    u64 cow_copies;
+    u64 cow_reuses;   // The last sharer only needed the page made writable
+    u64 pages_zeroed; // By vm_idle_refill()
+} VmStats;
+
+void  vm_init(void);
+void* vm_reserve(u64 pages, u32 flags);
+void* vm_duplicate(void* base);
+void  vm_release(void* base);
+void  vm_idle_refill(void);
+void  vm_print_stats(void);
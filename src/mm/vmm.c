@@ -0,0 +1,497 @@
+#include <limine.h>
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "cpu/smp.h"
+#include "drivers/serial.h"
+#include "panic.h"
+#include "mem.h"
+#include "pmm.h"
+#include "vmm.h"
+
+#define PTE_PRESENT   (1ull << 0)
+#define PTE_WRITE     (1ull << 1)
+#define PTE_USER      (1ull << 2)
+#define PTE_PWT       (1ull << 3)
+#define PTE_PCD       (1ull << 4)
+#define PTE_LARGE     (1ull << 7)  // PS bit in PDPT and PD entries
+#define PTE_PAT_4K    (1ull << 7)
+#define PTE_PAT_LARGE (1ull << 12)
+#define PTE_COW       (1ull << 9)  // Available to software, see VMM_FLAG_COW
+#define PTE_NX        (1ull << 63)
+
+#define PTE_ADDRESS_MASK 0x000FFFFFFFFFF000ull
+
+// PAT entries 0-7: WB, WT, UC-, UC, WC, WP, UC-, UC. The first four match
+// the power-on default so PCD/PWT keep their usual meaning, WC is reached
+// by setting the PAT bit alone.
+#define PAT_LAYOUT 0x0007050100070406ull
+
+// Levels are counted from the bottom: 0 is the page table, 3 the PML4.
+#define PAGING_LEVELS 4
+
+extern u8 kernel_text_start[], kernel_text_end[];
+extern u8 kernel_rodata_start[], kernel_rodata_end[];
+extern u8 kernel_data_start[], kernel_data_end[];
+
+static u64  kernel_pml4_phys;
+static bool nx_supported;
+static bool huge_pages_supported;
+static u64  mappings_by_level[3];
+static u64  kernel_alloc_next = VMM_KERNEL_ALLOC_BASE;
+
+// Serialises page table changes. Irqsave, the page fault path maps too.
+static Spinlock vmm_lock;
+
+static inline u64 level_size(u32 level) {
+    return (u64)PAGE_SIZE << (9*level);
+}
+
+static inline u64 table_index(u64 virt, u32 level) {
+    return (virt >> (PAGE_SHIFT + 9*level)) & 511;
+}
+
+static inline u64* table_virt(u64 entry) {
+    return phys_to_virt(entry & PTE_ADDRESS_MASK);
+}
+
+static u64 alloc_table(void) {
+    u64 phys = pmm_alloc_page();
+    if (phys != 0) {
+        memset(phys_to_virt(phys), 0, PAGE_SIZE);
+    }
+
+    return phys;
+}
+
+static u64 leaf_flags(u32 flags, u32 level) {
+    u64 entry = PTE_PRESENT;
+    if (flags & VMM_FLAG_WRITE) {
+        entry |= PTE_WRITE;
+    }
+
+    if (flags & VMM_FLAG_USER) {
+        entry |= PTE_USER;
+    }
+
+    if (!(flags & VMM_FLAG_EXEC) && nx_supported) {
+        entry |= PTE_NX;
+    }
+
+    if (flags & VMM_FLAG_COW) {
+        entry |= PTE_COW;
+    }
+
+    if (flags & VMM_FLAG_WC) {
+        entry |= (level == 0) ? PTE_PAT_4K : PTE_PAT_LARGE;
+    }
+    else if (flags & VMM_FLAG_UNCACHED) {
+        entry |= PTE_PCD | PTE_PWT;
+    }
+
+    if (level != 0) {
+        entry |= PTE_LARGE;
+    }
+
+    return entry;
+}
+
+// Replaces a large page with a table one level down that maps the same range
+// with the same attributes, so part of it can be remapped or unmapped.
+static bool split_large(u64* entry, u32 level, TlbBatch* batch, u64 virt) {
+    u64 table_phys = alloc_table();
+    if (table_phys == 0) {
+        return false;
+    }
+
+    u64  old        = *entry;
+    u64* table      = phys_to_virt(table_phys);
+    u64  base       = old & PTE_ADDRESS_MASK & ~(level_size(level)-1);
+    u64  child_size = level_size(level-1);
+    u64  attributes = old & ~PTE_ADDRESS_MASK & ~PTE_LARGE;
+
+    if (level-1 == 0) {
+        attributes |= (old & PTE_PAT_LARGE) ? PTE_PAT_4K : 0;
+    }
+    else {
+        attributes |= PTE_LARGE | (old & PTE_PAT_LARGE);
+    }
+
+    for (u64 i = 0; i < 512; i++) {
+        table[i] = (base + i*child_size) | attributes;
+    }
+
+    *entry = table_phys | PTE_PRESENT | PTE_WRITE | (old & PTE_USER);
+    mappings_by_level[level]--;
+    mappings_by_level[level-1] += 512;
+
+    // The translation doesn't change but the CPU may still hold the large
+    // entry, one invlpg anywhere in the range drops it.
+    tlb_batch_add(batch, virt);
+    return true;
+}
+
+// Returns the entry mapping `virt` at `target_level`, creating tables and
+// splitting large pages on the way down. NULL when out of memory.
+static u64* walk_create(u64 virt, u32 target_level, u32 flags, TlbBatch* batch) {
+    u64* table = phys_to_virt(kernel_pml4_phys);
+
+    for (u32 level = PAGING_LEVELS-1; level > target_level; level--) {
+        u64* entry = &table[table_index(virt, level)];
+
+        if (!(*entry & PTE_PRESENT)) {
+            u64 table_phys = alloc_table();
+            if (table_phys == 0) {
+                return NULL;
+            }
+
+            *entry = table_phys | PTE_PRESENT | PTE_WRITE;
+        }
+        else if (*entry & PTE_LARGE) {
+            if (!split_large(entry, level, batch, virt)) {
+                return NULL;
+            }
+        }
+
+        if (flags & VMM_FLAG_USER) {
+            *entry |= PTE_USER;
+        }
+
+        table = table_virt(*entry);
+    }
+
+    return &table[table_index(virt, target_level)];
+}
+
+static u32 largest_level_for(u64 virt, u64 phys, u64 pages) {
+    for (u32 level = huge_pages_supported ? 2 : 1; level > 0; level--) {
+        u64 size = level_size(level);
+        if ((virt & (size-1)) == 0 && (phys & (size-1)) == 0 && pages*PAGE_SIZE >= size) {
+            return level;
+        }
+    }
+
+    return 0;
+}
+
+static bool map_pages(u64 virt, u64 phys, u64 pages, u32 flags, TlbBatch* batch) {
+    while (pages > 0) {
+        u32  level = largest_level_for(virt, phys, pages);
+        u64* entry;
+
+        // Use large pages where alignment allows, unless a table already sits
+        // in that slot, then map through the table instead.
+        for (;;) {
+            entry = walk_create(virt, level, flags, batch);
+            if (entry == NULL) {
+                return false;
+            }
+
+            if (level == 0 || !(*entry & PTE_PRESENT) || (*entry & PTE_LARGE)) {
+                break;
+            }
+
+            level--;
+        }
+
+        if (*entry & PTE_PRESENT) {
+            tlb_batch_add(batch, virt);
+        }
+        else {
+            mappings_by_level[level]++;
+        }
+
+        *entry = phys | leaf_flags(flags, level);
+
+        virt  += level_size(level);
+        phys  += level_size(level);
+        pages -= level_size(level) / PAGE_SIZE;
+    }
+
+    return true;
+}
+
+static void unmap_pages(u64 virt, u64 pages, TlbBatch* batch) {
+    while (pages > 0) {
+        u64* table = phys_to_virt(kernel_pml4_phys);
+        u32  level = PAGING_LEVELS-1;
+
+        for (;;) {
+            u64* entry = &table[table_index(virt, level)];
+            u64  size  = level_size(level);
+
+            if (!(*entry & PTE_PRESENT)) {
+                // Nothing mapped down here, skip to the end of this entry.
+                u64 skip = (size - (virt & (size-1))) / PAGE_SIZE;
+                skip = skip < pages ? skip : pages;
+                virt  += skip * PAGE_SIZE;
+                pages -= skip;
+                break;
+            }
+
+            if (level == 0 || (*entry & PTE_LARGE)) {
+                if ((virt & (size-1)) == 0 && pages*PAGE_SIZE >= size) {
+                    *entry = 0;
+                    mappings_by_level[level]--;
+                    tlb_batch_add(batch, virt);
+                    virt  += size;
+                    pages -= size / PAGE_SIZE;
+                    break;
+                }
+
+                // Only part of a large page goes away, split it and retry.
+                if (!split_large(entry, level, batch, virt)) {
+                    panic(strlit("vmm: out of memory splitting a large page"));
+                }
+            }
+
+            table = table_virt(*entry);
+            level--;
+        }
+    }
+}
+
+// A NULL batch means the caller wants the change visible on return. The
+// invalidations are still collected and only flushed once the lock is
+// dropped, a shootdown waits on other CPUs that may be spinning on it.
+bool vmm_map(u64 virt, u64 phys, u64 pages, u32 flags, TlbBatch* batch) {
+    TlbBatch local = {};
+    TlbBatch* target = batch != NULL ? batch : &local;
+
+    u64  irq_flags = spin_lock_irqsave(&vmm_lock);
+    bool result    = map_pages(virt, phys, pages, flags, target);
+    spin_unlock_irqrestore(&vmm_lock, irq_flags);
+
+    if (batch == NULL) {
+        tlb_batch_flush(&local);
+    }
+
+    return result;
+}
+
+void vmm_unmap(u64 virt, u64 pages, TlbBatch* batch) {
+    TlbBatch local = {};
+    TlbBatch* target = batch != NULL ? batch : &local;
+
+    u64 irq_flags = spin_lock_irqsave(&vmm_lock);
+    unmap_pages(virt, pages, target);
+    spin_unlock_irqrestore(&vmm_lock, irq_flags);
+
+    if (batch == NULL) {
+        tlb_batch_flush(&local);
+    }
+}
+
+u64 vmm_translate(u64 virt) {
+    u64* table = phys_to_virt(kernel_pml4_phys);
+
+    for (u32 level = PAGING_LEVELS-1;; level--) {
+        u64 entry = table[table_index(virt, level)];
+        if (!(entry & PTE_PRESENT)) {
+            return 0;
+        }
+
+        if (level == 0 || (entry & PTE_LARGE)) {
+            u64 size = level_size(level);
+            return (entry & PTE_ADDRESS_MASK & ~(size-1)) + (virt & (size-1));
+        }
+
+        table = table_virt(entry);
+    }
+}
+
+// Like vmm_translate() but also reports how the page is mapped, as
+// VMM_FLAG_* bits. Caching attributes aren't reported.
+bool vmm_query(u64 virt, u64* phys, u32* flags) {
+    u64* table = phys_to_virt(kernel_pml4_phys);
+
+    for (u32 level = PAGING_LEVELS-1;; level--) {
+        u64 entry = table[table_index(virt, level)];
+        if (!(entry & PTE_PRESENT)) {
+            return false;
+        }
+
+        if (level == 0 || (entry & PTE_LARGE)) {
+            u64 size = level_size(level);
+            *phys  = (entry & PTE_ADDRESS_MASK & ~(size-1)) + (virt & (size-1) & ~(u64)(PAGE_SIZE-1));
+            *flags = ((entry & PTE_WRITE) ? VMM_FLAG_WRITE : 0) |
+                     ((entry & PTE_USER)  ? VMM_FLAG_USER  : 0) |
+                     ((entry & PTE_COW)   ? VMM_FLAG_COW   : 0) |
+                     ((entry & PTE_NX) || !nx_supported ? 0 : VMM_FLAG_EXEC);
+            return true;
+        }
+
+        table = table_virt(entry);
+    }
+}
+
+// Hands out `pages` of kernel address space followed by an unmapped guard
+// page. Nothing is mapped, that is up to the caller.
+u64 vmm_reserve(u64 pages) {
+    return __atomic_fetch_add(&kernel_alloc_next, (pages + 1) * PAGE_SIZE, __ATOMIC_RELAXED);
+}
+
+// Maps `pages` individually allocated frames at a fresh kernel address, for
+// buffers too big to expect physically contiguous memory for. Address
+// space is handed out bump style and not reused.
+void* vmm_alloc(u64 pages, u32 flags) {
+    u64 base = vmm_reserve(pages);
+
+    for (u64 i = 0; i < pages; i++) {
+        u64 phys = pmm_alloc_page();
+        if (phys == 0 || !vmm_map(base + i*PAGE_SIZE, phys, 1, flags, NULL)) {
+            if (phys != 0) {
+                pmm_free_page(phys);
+            }
+
+            vmm_free((void*)base, i);
+            return NULL;
+        }
+    }
+
+    return (void*)base;
+}
+
+// A frame only goes back to the PMM once no TLB can still reach it, so the
+// pages are unmapped and flushed in batches before their frames are freed.
+void vmm_free(void* address, u64 pages) {
+    u64      frames[TLB_BATCH_MAX_ENTRIES];
+    u32      frame_count = 0;
+    TlbBatch batch       = {};
+
+    for (u64 i = 0; i < pages; i++) {
+        u64 virt = (u64)address + i*PAGE_SIZE;
+        u64 phys = vmm_translate(virt);
+        if (phys != 0) {
+            vmm_unmap(virt, 1, &batch);
+            frames[frame_count++] = phys;
+        }
+
+        if (frame_count == TLB_BATCH_MAX_ENTRIES || (i + 1 == pages && frame_count > 0)) {
+            tlb_batch_flush(&batch);
+            for (u32 f = 0; f < frame_count; f++) {
+                pmm_free_page(frames[f]);
+            }
+            frame_count = 0;
+        }
+    }
+}
+
+void tlb_batch_add(TlbBatch* batch, u64 virt) {
+    if (batch == NULL) {
+        invlpg(virt);
+        smp_tlb_shootdown();
+        return;
+    }
+
+    if (batch->full_flush) {
+        return;
+    }
+
+    if (batch->count == TLB_BATCH_MAX_ENTRIES) {
+        batch->full_flush = true;
+        return;
+    }
+
+    batch->addresses[batch->count++] = virt;
+}
+
+// Other CPUs get a full flush whenever anything was invalidated here, see
+// smp_tlb_shootdown() for why this must not run with interrupts off.
+void tlb_batch_flush(TlbBatch* batch) {
+    bool changed = batch->full_flush || batch->count > 0;
+
+    if (batch->full_flush) {
+        write_cr3(read_cr3());
+    }
+    else {
+        for (u32 i = 0; i < batch->count; i++) {
+            invlpg(batch->addresses[i]);
+        }
+    }
+
+    batch->count = 0;
+    batch->full_flush = false;
+
+    if (changed) {
+        smp_tlb_shootdown();
+    }
+}
+
+static void map_kernel_section(u8* start, u8* end, u32 flags, struct limine_executable_address_response* executable) {
+    u64 virt  = (u64)start & ~(u64)(PAGE_SIZE-1);
+    u64 phys  = virt - executable->virtual_base + executable->physical_base;
+    u64 pages = ((u64)end - virt + PAGE_SIZE-1) / PAGE_SIZE;
+
+    if (!vmm_map(virt, phys, pages, flags, NULL)) {
+        panic(strlit("vmm: out of memory mapping the kernel"));
+    }
+}
+
+// Switches the calling CPU to the kernel page tables. The NX bit and the
+// PAT layout they rely on are per-CPU state, so every AP runs this too.
+void vmm_init_cpu(void) {
+    if (nx_supported) {
+        wrmsr(MSR_EFER, rdmsr(MSR_EFER) | EFER_NXE);
+    }
+
+    wrmsr(MSR_PAT, PAT_LAYOUT);
+    write_cr0(read_cr0() | CR0_WP);
+    write_cr3(kernel_pml4_phys);
+}
+
+void vmm_init(struct limine_memmap_response* memmap, struct limine_executable_address_response* executable) {
+    if (cpuid(0x80000000, 0).eax >= 0x80000001) {
+        CpuidResult extended = cpuid(0x80000001, 0);
+        nx_supported         = (extended.edx & CPUID_EXT_EDX_NX) != 0;
+        huge_pages_supported = (extended.edx & CPUID_EXT_EDX_PAGE1GB) != 0;
+    }
+
+    kernel_pml4_phys = alloc_table();
+    if (kernel_pml4_phys == 0) {
+        panic(strlit("vmm: out of memory allocating the PML4"));
+    }
+
+    // Nothing in the new tables is live yet, so there is nothing to flush.
+    TlbBatch batch = {};
+
+    for (u64 i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry* entry = memmap->entries[i];
+        u32 flags = VMM_FLAG_WRITE;
+
+        switch (entry->type) {
+            case LIMINE_MEMMAP_USABLE:
+            case LIMINE_MEMMAP_BOOTLOADER_RECLAIMABLE:
+            case LIMINE_MEMMAP_EXECUTABLE_AND_MODULES:
+            case LIMINE_MEMMAP_ACPI_RECLAIMABLE:
+            case LIMINE_MEMMAP_ACPI_NVS:
+                break;
+            case LIMINE_MEMMAP_FRAMEBUFFER:
+                flags |= VMM_FLAG_WC;
+                break;
+            default:
+                continue;
+        }
+
+        u64 base = entry->base & ~(u64)(PAGE_SIZE-1);
+        u64 end  = (entry->base + entry->length + PAGE_SIZE-1) & ~(u64)(PAGE_SIZE-1);
+        if (!vmm_map(hhdm_offset + base, base, (end - base) / PAGE_SIZE, flags, &batch)) {
+            panic(strlit("vmm: out of memory mapping the HHDM"));
+        }
+    }
+
+    map_kernel_section(kernel_text_start,   kernel_text_end,   VMM_FLAG_EXEC,  executable);
+    map_kernel_section(kernel_rodata_start, kernel_rodata_end, 0,              executable);
+    map_kernel_section(kernel_data_start,   kernel_data_end,   VMM_FLAG_WRITE, executable);
+
+    vmm_init_cpu();
+
+    print_log(strlit("vmm: mapped with "));
+    print_log_u64(mappings_by_level[2]);
+    print_log(strlit(" 1GiB, "));
+    print_log_u64(mappings_by_level[1]);
+    print_log(strlit(" 2MiB and "));
+    print_log_u64(mappings_by_level[0]);
+    print_log(strlit(" 4KiB pages\n"));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Kernel virtual memory manager. vmm_init() builds a fresh PML4 that maps
+// the higher-half direct map with the largest pages alignment allows and the
+// kernel image with per-section permissions, then switches to it.
+//
+// Mapping changes are collected in a TlbBatch and invalidated together by
+// tlb_batch_flush(): a handful of invlpg for small batches, a single CR3
+// reload once the batch grows past TLB_BATCH_MAX_ENTRIES. With more than
+// one CPU online a flush also shoots down the other CPUs' TLBs, so it must
+// be called with interrupts enabled and no spinlocks held.
+
+struct limine_memmap_response;
+struct limine_executable_address_response;
+
+#define VMM_FLAG_WRITE    (1 << 0)
+#define VMM_FLAG_EXEC     (1 << 1)
+#define VMM_FLAG_USER     (1 << 2)
+#define VMM_FLAG_WC       (1 << 3) // Write-combining, for framebuffers
+#define VMM_FLAG_UNCACHED (1 << 4) // Strong uncacheable, for MMIO
+#define VMM_FLAG_COW      (1 << 5) // Read-only share of a frame, see mm/vm.h
+
+#define LARGE_PAGE_SIZE MB(2)
+#define HUGE_PAGE_SIZE  GB(1)
+
+#define TLB_BATCH_MAX_ENTRIES 32
+
+// vmm_alloc() hands out virtually contiguous kernel memory from here, backed
+// by whatever physical pages are free.
+#define VMM_KERNEL_ALLOC_BASE 0xFFFFC00000000000
+
+typedef struct {
+    u64 addresses[TLB_BATCH_MAX_ENTRIES];
+    u32 count;
+    bool full_flush;
+} TlbBatch;
+
+void vmm_init(struct limine_memmap_response* memmap, struct limine_executable_address_response* executable);
+void vmm_init_cpu(void);
+bool vmm_map(u64 virt, u64 phys, u64 pages, u32 flags, TlbBatch* batch);
+void vmm_unmap(u64 virt, u64 pages, TlbBatch* batch);
+u64  vmm_translate(u64 virt);
+bool vmm_query(u64 virt, u64* phys, u32* flags);
+u64  vmm_reserve(u64 pages);
+void* vmm_alloc(u64 pages, u32 flags);
+void  vmm_free(void* address, u64 pages);
+void tlb_batch_add(TlbBatch* batch, u64 virt);
+void tlb_batch_flush(TlbBatch* batch);
@@ -0,0 +1,39 @@
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "gfx/gfx.h"
+#include "panic.h"
+
+// Halt and catch fire function. The console's presenter won't run again,
+// so what it hasn't put on the screen yet goes out here.
+void hcf(void) {
+    serial_flush();
+    gfx_present();
+    asm ("cli");
+    for (;;) {
+        asm ("hlt");
+    }
+}
+
+void panic(String message) {
+    serial_force_polled();
+    print_log(strlit("PANIC: "));
+    print_log(message);
+    print_log(strlit("\n"));
+    hcf();
+}
+
+void panic_assert(const char* file, int line) {
+    serial_force_polled();
+    u64 file_len = 0;
+    while (file[file_len] != 0) {
+        file_len++;
+    }
+
+    print_log(strlit("PANIC: Assertion in file: "));
+    print_log((String) { (char*)file, file_len });
+    print_log(strlit(" at line "));
+    print_log_u64(line);
+    print_log(strlit("\n"));
+    hcf();
+}
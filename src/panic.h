@@ -0,0 +1,10 @@
+#pragma once
+
+__attribute__((noreturn)) void hcf(void);
+__attribute__((noreturn)) void panic(String message);
+__attribute__((noreturn)) void panic_assert(const char* file, int line);
+
+#define Assert(expression) \
+    if (!(expression)) { \
+        panic_assert(__FILE__, __LINE__); \
+    }
@@ -0,0 +1,81 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "run_queue.h"
+#include "sched.h"
+
+void run_queue_init(RunQueue* queue) {
+    *queue = (RunQueue) {};
+}
+
+void run_queue_push(RunQueue* queue, Thread* thread) {
+    u64 flags = spin_lock_irqsave(&queue->lock);
+
+    thread->next = NULL;
+    thread->prev = queue->tail;
+    if (queue->tail != NULL) {
+        queue->tail->next = thread;
+    }
+    else {
+        queue->head = thread;
+    }
+
+    queue->tail = thread;
+    __atomic_store_n(&queue->length, queue->length + 1, __ATOMIC_RELAXED);
+    spin_unlock_irqrestore(&queue->lock, flags);
+}
+
+static void unlink(RunQueue* queue, Thread* thread) {
+    if (thread->prev != NULL) {
+        thread->prev->next = thread->next;
+    }
+    else {
+        queue->head = thread->next;
+    }
+
+    if (thread->next != NULL) {
+        thread->next->prev = thread->prev;
+    }
+    else {
+        queue->tail = thread->prev;
+    }
+
+    thread->next = NULL;
+    thread->prev = NULL;
+    __atomic_store_n(&queue->length, queue->length - 1, __ATOMIC_RELAXED);
+}
+
+Thread* run_queue_pop(RunQueue* queue) {
+    if (run_queue_length(queue) == 0) {
+        return NULL;
+    }
+
+    u64 flags = spin_lock_irqsave(&queue->lock);
+    Thread* thread = queue->head;
+    if (thread != NULL) {
+        unlink(queue, thread);
+    }
+
+    spin_unlock_irqrestore(&queue->lock, flags);
+    return thread;
+}
+
+Thread* run_queue_steal(RunQueue* queue) {
+    if (run_queue_length(queue) == 0) {
+        return NULL;
+    }
+
+    u64 flags = spin_lock_irqsave(&queue->lock);
+    Thread* thread = queue->tail;
+    if (thread != NULL) {
+        unlink(queue, thread);
+    }
+
+    spin_unlock_irqrestore(&queue->lock, flags);
+    return thread;
+}
+
+u32 run_queue_length(RunQueue* queue) {
+    return __atomic_load_n(&queue->length, __ATOMIC_RELAXED);
+}
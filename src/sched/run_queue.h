@@ -0,0 +1,29 @@
+#pragma once
+
+// Per-CPU run queue. The owning CPU pushes at the tail and pops from the
+// head, round robin, while idle CPUs steal from the tail, so a thief takes
+// the thread that would have waited longest here. Every queue has its own
+// lock, there is no global scheduler lock. Needs cpu/spinlock.h.
+
+struct Thread;
+
+typedef struct {
+    Spinlock       lock;
+    struct Thread* head;
+    struct Thread* tail;
+    u32            length; // Read without the lock when picking a victim
+} RunQueue;
+
+typedef struct {
+    u64 context_switches;
+    u64 preemptions;
+    u64 steals;
+    u64 idle_cycles;
+    u64 ticks; // Time slices that ran out
+} SchedStats;
+
+void           run_queue_init(RunQueue* queue);
+void           run_queue_push(RunQueue* queue, struct Thread* thread);
+struct Thread* run_queue_pop(RunQueue* queue);
+struct Thread* run_queue_steal(RunQueue* queue);
+u32            run_queue_length(RunQueue* queue);
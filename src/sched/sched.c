@@ -0,0 +1,402 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "drivers/lapic.h"
+#include "mm/pmm.h"
+#include "mm/slab.h"
+#include "mm/vm.h"
+#include "time/tsc.h"
+#include "time/timer.h"
+#include "panic.h"
+#include "run_queue.h"
+#include "cpu/percpu.h"
+#include "sched.h"
+#include "sync/rcu.h"
+#include "trace/trace.h"
+
+static SlabCache* thread_cache;
+static u32        next_thread_id;
+static u32        next_spawn_cpu;
+static u64        sched_start_tsc;
+static Timer      slice_timers[MAX_CPUS];
+
+__attribute__((used)) void thread_start(ThreadFunction function, void* argument);
+
+// Saves the callee-saved registers on the current stack, stores the stack
+// pointer through rdi, then loads rsi as the new stack and pops the same
+// registers back in reverse. The ret lands wherever the new thread last
+// called switch_context(), or in thread_entry for a fresh one.
+__attribute__((naked)) void switch_context(u64* save_rsp, u64 new_rsp) {
+    asm (
+            "push rbx\n"
+            "push rbp\n"
+            "push r12\n"
+            "push r13\n"
+            "push r14\n"
+            "push r15\n"
+            "mov [rdi], rsp\n"
+            "mov rsp, rsi\n"
+            "pop r15\n"
+            "pop r14\n"
+            "pop r13\n"
+            "pop r12\n"
+            "pop rbp\n"
+            "pop rbx\n"
+            "ret\n"
+    );
+}
+
+// First code a new thread runs, its function and argument come in through
+// r12 and r13 from the frame thread_create() built.
+__attribute__((naked)) static void thread_entry(void) {
+    asm (
+            "mov rdi, r12\n"
+            "mov rsi, r13\n"
+            "call thread_start\n"
+            "ud2\n"
+    );
+}
+
+// Called right after every switch, on the new thread's stack. The previous
+// thread only goes back on a run queue (or gets freed) here: before the
+// switch it was still running on its stack and another CPU could have
+// stolen it.
+static void finish_switch(void) {
+    PerCpu* cpu  = this_cpu();
+    Thread* prev = cpu->switch_from;
+    cpu->switch_from = NULL;
+
+    if (prev == NULL || prev == cpu->idle_thread) {
+        return;
+    }
+
+    if (prev->state == THREAD_READY) {
+        run_queue_push(&cpu->run_queue, prev);
+    }
+    else if (prev->state == THREAD_DEAD) {
+        pmm_free_pages(prev->stack, THREAD_STACK_SIZE / PAGE_SIZE);
+        slab_free(thread_cache, prev);
+    }
+}
+
+void thread_start(ThreadFunction function, void* argument) {
+    finish_switch();
+    interrupts_enable();
+    function(argument);
+    thread_exit();
+}
+
+// Takes a thread from the CPU with the longest queue. The lengths are read
+// without locks, a stale one only means a wasted or missed attempt.
+static Thread* steal(PerCpu* self) {
+    PerCpu* victim  = NULL;
+    u32     longest = 0;
+
+    for (u32 i = 0; i < percpu_count(); i++) {
+        PerCpu* cpu = percpu_get(i);
+        u32 length = run_queue_length(&cpu->run_queue);
+        if (cpu != self && length > longest) {
+            victim  = cpu;
+            longest = length;
+        }
+    }
+
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    Thread* thread = run_queue_steal(&victim->run_queue);
+    if (thread != NULL) {
+        self->sched_stats.steals++;
+        TRACE(SCHED_STEAL, thread->id, victim->cpu_id);
+    }
+
+    return thread;
+}
+
+static void arm_slice(PerCpu* cpu) {
+    timer_arm_ns(&slice_timers[cpu->cpu_id], SCHED_SLICE_US * 1000);
+}
+
+// Picks the next thread and switches to it. Runs with interrupts off. The
+// current thread keeps the CPU if it is still runnable and nothing else is.
+static void schedule(bool preempt) {
+    PerCpu* cpu  = this_cpu();
+    Thread* prev = cpu->current;
+    rcu_quiescent();
+
+    Thread* next = run_queue_pop(&cpu->run_queue);
+    if (next == NULL) {
+        next = steal(cpu);
+    }
+
+    if (next == NULL) {
+        if (prev->state == THREAD_RUNNING) {
+            if (preempt) {
+                arm_slice(cpu);
+            }
+            return;
+        }
+
+        next = cpu->idle_thread;
+    }
+
+    if (prev->state == THREAD_RUNNING) {
+        prev->state = THREAD_READY;
+    }
+
+    next->state      = THREAD_RUNNING;
+    cpu->current     = next;
+    cpu->switch_from = prev;
+    cpu->sched_stats.context_switches++;
+    if (preempt) {
+        cpu->sched_stats.preemptions++;
+    }
+    TRACE(SCHED_SWITCH, prev->id, next->id, preempt);
+
+    // The idle thread runs without a slice, so an idle CPU takes no timer
+    // interrupts it doesn't need.
+    if (next == cpu->idle_thread) {
+        timer_cancel(&slice_timers[cpu->cpu_id]);
+    }
+    else {
+        arm_slice(cpu);
+    }
+
+    switch_context(&prev->rsp, next->rsp);
+
+    // Back on prev's stack, possibly on another CPU by now.
+    finish_switch();
+}
+
+// Only flags the switch, it happens in sched_interrupt_exit() once every
+// other due timer has run.
+static void slice_expired(Timer* timer) {
+    PerCpu* cpu = timer->argument;
+    cpu->sched_stats.ticks++;
+    cpu->need_resched = true;
+}
+
+// Wakes one idle CPU other than `busy` and the caller, so it can steal
+// from `busy`. Without a periodic tick idle CPUs don't go looking for work
+// on their own.
+static void kick_idle_cpu(PerCpu* busy) {
+    u32 count = percpu_count();
+
+    for (u32 i = 1; i < count; i++) {
+        PerCpu* cpu = percpu_get((busy->cpu_id + i) % count);
+        if (cpu != this_cpu() && __atomic_load_n(&cpu->online, __ATOMIC_ACQUIRE) &&
+                cpu->current == cpu->idle_thread)
+        {
+            lapic_send_ipi(cpu->lapic_id, VECTOR_IPI_WAKEUP);
+            return;
+        }
+    }
+}
+
+// Queues a thread on `cpu` and makes sure someone picks it up soon: the
+// target itself if it is idle, otherwise an idle CPU that can steal it.
+static void make_runnable(PerCpu* cpu, Thread* thread) {
+    run_queue_push(&cpu->run_queue, thread);
+
+    if (cpu->current == cpu->idle_thread) {
+        if (cpu != this_cpu()) {
+            lapic_send_ipi(cpu->lapic_id, VECTOR_IPI_WAKEUP);
+        }
+    }
+    else {
+        kick_idle_cpu(cpu);
+    }
+}
+
+static void timer_interrupt(InterruptFrame* frame) {
+    lapic_eoi();
+    timer_expire();
+}
+
+// Called by interrupt_dispatch() last, once the handler's time is
+// accounted for, since the switch only returns when this thread runs again.
+void sched_interrupt_exit(void) {
+    PerCpu* cpu = this_cpu();
+    if (!cpu->need_resched) {
+        return;
+    }
+
+    cpu->need_resched = false;
+    if (cpu->current != cpu->idle_thread) {
+        if (run_queue_length(&cpu->run_queue) != 0) {
+            kick_idle_cpu(cpu);
+        }
+
+        schedule(true);
+    }
+}
+
+void sched_init(void) {
+    thread_cache = slab_cache_create(strlit("thread"), sizeof(Thread), NULL);
+    if (thread_cache == NULL) {
+        panic(strlit("sched: out of memory creating the thread cache"));
+    }
+
+    interrupt_register(VECTOR_LAPIC_TIMER, timer_interrupt);
+    timer_init();
+    sched_start_tsc = tsc_read();
+    sched_init_cpu();
+}
+
+// Turns the calling CPU's boot context into its idle thread and starts the
+// scheduler tick.
+void sched_init_cpu(void) {
+    Thread* idle = slab_alloc(thread_cache);
+    if (idle == NULL) {
+        panic(strlit("sched: out of memory creating an idle thread"));
+    }
+
+    PerCpu* cpu = this_cpu();
+    *idle = (Thread) {
+        .state = THREAD_RUNNING,
+        .id    = __atomic_fetch_add(&next_thread_id, 1, __ATOMIC_RELAXED),
+        .name  = strlit("idle")
+    };
+
+    cpu->idle_thread = idle;
+    cpu->current     = idle;
+    timer_setup(&slice_timers[cpu->cpu_id], slice_expired, cpu);
+}
+
+Thread* thread_create(String name, ThreadFunction function, void* argument, u32 cpu_id) {
+    Thread* thread = slab_alloc(thread_cache);
+    if (thread == NULL) {
+        return NULL;
+    }
+
+    u64 stack = pmm_alloc_pages(THREAD_STACK_SIZE / PAGE_SIZE);
+    if (stack == 0) {
+        slab_free(thread_cache, thread);
+        return NULL;
+    }
+
+    // Frame for switch_context() to pop: r15, r14, r13, r12, rbp, rbx and
+    // the return address. Placed so that rsp is 16 byte aligned again at
+    // the call in thread_entry.
+    u64  top   = (u64)phys_to_virt(stack) + THREAD_STACK_SIZE;
+    u64* frame = (u64*)(top - 72);
+    frame[0] = 0;                   // r15
+    frame[1] = 0;                   // r14
+    frame[2] = (u64)argument;       // r13
+    frame[3] = (u64)function;       // r12
+    frame[4] = 0;                   // rbp
+    frame[5] = 0;                   // rbx
+    frame[6] = (u64)thread_entry;
+
+    *thread = (Thread) {
+        .rsp      = (u64)frame,
+        .state    = THREAD_READY,
+        .id       = __atomic_fetch_add(&next_thread_id, 1, __ATOMIC_RELAXED),
+        .name     = name,
+        .function = function,
+        .argument = argument,
+        .stack    = stack
+    };
+
+    if (cpu_id == SCHED_ANY_CPU) {
+        cpu_id = __atomic_fetch_add(&next_spawn_cpu, 1, __ATOMIC_RELAXED) % percpu_count();
+    }
+
+    TRACE(THREAD_CREATE, thread->id, cpu_id);
+
+    make_runnable(percpu_get(cpu_id), thread);
+    return thread;
+}
+
+Thread* thread_current(void) {
+    return this_cpu()->current;
+}
+
+void thread_yield(void) {
+    u64 flags = interrupts_save();
+    schedule(false);
+    interrupts_restore(flags);
+}
+
+static void sleep_expired(Timer* timer) {
+    Thread* thread = timer->argument;
+    thread->state = THREAD_READY;
+    make_runnable(this_cpu(), thread);
+}
+
+// Blocks the calling thread for at least `ns`. The wakeup comes from a
+// timer on this CPU, which can only fire once the thread has switched out,
+// and puts it at the tail of this CPU's queue, where an idle CPU steals it
+// right away. The latency past the deadline is only the time until some
+// CPU can run it.
+void thread_sleep_ns(u64 ns) {
+    u64 flags = interrupts_save();
+    PerCpu* cpu  = this_cpu();
+    Thread* self = cpu->current;
+    Assert(self != cpu->idle_thread);
+
+    Timer timer;
+    timer_setup(&timer, sleep_expired, self);
+    timer_arm_ns(&timer, ns);
+
+    self->state = THREAD_BLOCKED;
+    schedule(false);
+    interrupts_restore(flags);
+}
+
+void thread_exit(void) {
+    interrupts_disable();
+    TRACE(THREAD_EXIT, this_cpu()->current->id);
+    this_cpu()->current->state = THREAD_DEAD;
+    schedule(false);
+    panic(strlit("sched: dead thread was scheduled again"));
+}
+
+// Body of every CPU's idle thread. Work that shows up is either queued
+// here or stolen after a wakeup IPI, see make_runnable(). Nothing else
+// interrupts the hlt unless a timer on this CPU is due. The check runs with
+// interrupts off and `sti; hlt` only opens the interrupt window once hlt has
+// started, so a wakeup can't slip in between.
+void sched_idle_loop(void) {
+    for (;;) {
+        vm_idle_refill();
+        interrupts_disable();
+
+        PerCpu* cpu = this_cpu();
+        schedule(false);
+
+        u64 start = tsc_read();
+        asm volatile ("sti\n" "hlt" ::: "memory");
+        cpu->sched_stats.idle_cycles += tsc_read() - start;
+    }
+}
+
+void sched_print_stats(void) {
+    u64 elapsed = tsc_read() - sched_start_tsc;
+
+    for (u32 i = 0; i < percpu_count(); i++) {
+        PerCpu*     cpu   = percpu_get(i);
+        SchedStats* stats = &cpu->sched_stats;
+
+        print_log(strlit("sched: cpu "));
+        print_log_u64(cpu->cpu_id);
+        print_log(strlit(" switches="));
+        print_log_u64(stats->context_switches);
+        print_log(strlit(" preemptions="));
+        print_log_u64(stats->preemptions);
+        print_log(strlit(" steals="));
+        print_log_u64(stats->steals);
+        print_log(strlit(" ticks="));
+        print_log_u64(stats->ticks);
+        print_log(strlit(" idle_us="));
+        print_log_u64(tsc_to_ns(stats->idle_cycles) / 1000);
+        print_log(strlit(" idle="));
+        print_log_u64(elapsed ? stats->idle_cycles * 100 / elapsed : 0);
+        print_log(strlit("%\n"));
+    }
+}
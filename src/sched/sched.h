@@ -0,0 +1,48 @@
+#pragma once
+
+// Preemptive kernel threads. Every CPU runs threads from its own RunQueue,
+// switching when the running thread's time slice timer expires or it
+// yields, sleeps or exits. A CPU whose queue runs dry steals from the CPU
+// with the longest queue before falling back to its idle thread, which has
+// no slice and halts until a wakeup IPI or a due timer. There is no
+// periodic tick, see time/timer.h.
+//
+// switch_context() only saves the callee-saved registers: every switch
+// starts from a C call, so the caller-saved ones are either dead or were
+// already saved by the interrupt entry path.
+
+#define THREAD_STACK_SIZE KB(16)
+#define SCHED_SLICE_US    10000
+#define SCHED_ANY_CPU     0xFFFFFFFF
+
+typedef void (*ThreadFunction)(void* argument);
+
+typedef enum {
+    THREAD_READY,
+    THREAD_RUNNING,
+    THREAD_BLOCKED,
+    THREAD_DEAD
+} ThreadState;
+
+typedef struct Thread {
+    u64            rsp;   // Saved stack pointer while switched out
+    ThreadState    state;
+    u32            id;
+    String         name;
+    ThreadFunction function;
+    void*          argument;
+    u64            stack; // Physical base, 0 for a CPU's boot context
+    struct Thread* next;  // RunQueue links
+    struct Thread* prev;
+} Thread;
+
+void    sched_init(void);
+void    sched_init_cpu(void);
+Thread* thread_create(String name, ThreadFunction function, void* argument, u32 cpu_id);
+Thread* thread_current(void);
+void    thread_yield(void);
+void    thread_sleep_ns(u64 ns);
+__attribute__((noreturn)) void thread_exit(void);
+__attribute__((noreturn)) void sched_idle_loop(void);
+void    sched_interrupt_exit(void);
+void    sched_print_stats(void);
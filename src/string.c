@@ -0,0 +1,18 @@
+#include <util.h>
+#include "mem.h"
+#include "string.h"
+
+bool string_equal(String a, String b) {
+    return a.len == b.len && memcmp(a.string, b.string, a.len) == 0;
+}
+
+// 64-bit FNV-1a.
+u64 string_hash(String string) {
+    u64 hash = 0xCBF29CE484222325;
+    for (u64 i = 0; i < string.len; i++) {
+        hash ^= (u8)string.string[i];
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
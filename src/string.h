@@ -6,3 +6,6 @@ typedef struct {
 } String;
 
 #define strlit(s) (String) { s, sizeof(s)-1 }
+
+bool string_equal(String a, String b);
+u64  string_hash(String string);
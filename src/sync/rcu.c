@@ -0,0 +1,70 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "cpu/smp.h"
+#include "drivers/serial.h"
+#include "drivers/lapic.h"
+#include "rcu.h"
+
+typedef struct {
+    u64 quiescent; // Quiescent states passed, only written by its CPU
+} __attribute__((aligned(64))) RcuCpu;
+
+static RcuCpu rcu_cpus[MAX_CPUS];
+static u64    grace_periods;
+
+// Called with interrupts off, from outside any read-side section.
+void rcu_quiescent(void) {
+    RcuCpu* rcu = &rcu_cpus[this_cpu()->cpu_id];
+    __atomic_store_n(&rcu->quiescent, rcu->quiescent + 1, __ATOMIC_RELEASE);
+}
+
+// The calling CPU is outside any read-side section by definition. If the
+// thread migrates halfway, the CPU it left can only start readers that see
+// the new version, and the one it lands on was sent the IPI like any other.
+// Two callers waiting on each other both keep interrupts on, so they each
+// take the other's IPI.
+void synchronize_rcu(void) {
+    if (smp_online_count() <= 1) {
+        return;
+    }
+
+    u64 snapshot[MAX_CPUS];
+    u32 self  = this_cpu()->cpu_id;
+    u32 count = percpu_count();
+    asm volatile ("mfence" ::: "memory"); // Publish the update before sampling
+
+    for (u32 i = 0; i < count; i++) {
+        snapshot[i] = __atomic_load_n(&rcu_cpus[i].quiescent, __ATOMIC_ACQUIRE);
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        PerCpu* cpu = percpu_get(i);
+        if (i != self && __atomic_load_n(&cpu->online, __ATOMIC_ACQUIRE)) {
+            lapic_send_ipi(cpu->lapic_id, VECTOR_IPI_WAKEUP);
+        }
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        if (i == self || !__atomic_load_n(&percpu_get(i)->online, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        while (__atomic_load_n(&rcu_cpus[i].quiescent, __ATOMIC_ACQUIRE) == snapshot[i]) {
+            cpu_pause();
+        }
+    }
+
+    __atomic_add_fetch(&grace_periods, 1, __ATOMIC_RELAXED);
+}
+
+void rcu_print_stats(void) {
+    print_log(strlit("rcu: grace periods="));
+    print_log_u64(__atomic_load_n(&grace_periods, __ATOMIC_RELAXED));
+    print_log(strlit("\n"));
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Quiescent-state RCU for lookups that take no lock. A reader brackets its
+// access with rcu_read_lock()/rcu_read_unlock(), which only disable and
+// restore interrupts, and must not sleep or yield in between. An updater
+// publishes a new version with rcu_assign_pointer(), calls
+// synchronize_rcu() and may then free the old one: by the time it returns
+// every CPU has passed a quiescent state, a point where it can't be inside
+// a read-side section that started before the update.
+//
+// Since readers keep interrupts off, taking an interrupt or going through
+// schedule() is such a point. synchronize_rcu() sends every other online
+// CPU a wakeup IPI and waits for each to count one. Like the TLB shootdown
+// it needs interrupts enabled and no spinlock held that another CPU might
+// be spinning on with interrupts off.
+
+#define rcu_assign_pointer(pointer, value) __atomic_store_n(&(pointer), (value), __ATOMIC_RELEASE)
+#define rcu_dereference(pointer)           __atomic_load_n(&(pointer), __ATOMIC_ACQUIRE)
+
+static inline u64 rcu_read_lock(void) {
+    return interrupts_save();
+}
+
+static inline void rcu_read_unlock(u64 flags) {
+    interrupts_restore(flags);
+}
+
+void rcu_quiescent(void);
+void synchronize_rcu(void);
+void rcu_print_stats(void);
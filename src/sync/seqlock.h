@@ -0,0 +1,48 @@
+#pragma once
+
+// Sequence lock for small read-mostly data. Writers serialize on a
+// spinlock and bump the sequence before and after the update, so it is odd
+// while one is in progress. Readers take no lock and write nothing, they
+// copy the data out and retry if the sequence moved underneath them:
+//
+//     u32 sequence;
+//     do {
+//         sequence = read_seqbegin(&lock);
+//         copy = data;
+//     } while (read_seqretry(&lock, sequence));
+//
+// x86 keeps loads in order with loads and stores with stores, so compiler
+// barriers are all the ordering either side needs. The data read inside the
+// loop must be naturally aligned words, a retry only catches a torn copy
+// between them. Needs cpu/cpu.h and cpu/spinlock.h.
+
+typedef struct {
+    volatile u32 sequence; // Odd while a write is in progress
+    Spinlock     writer;
+} Seqlock;
+
+static inline u64 write_seqlock(Seqlock* lock) {
+    u64 flags = spin_lock_irqsave(&lock->writer);
+    asm volatile ("add %0, 1" : "+m" (lock->sequence) : : "memory");
+    return flags;
+}
+
+static inline void write_sequnlock(Seqlock* lock, u64 flags) {
+    asm volatile ("add %0, 1" : "+m" (lock->sequence) : : "memory");
+    spin_unlock_irqrestore(&lock->writer, flags);
+}
+
+static inline u32 read_seqbegin(const Seqlock* lock) {
+    u32 sequence;
+    while ((sequence = lock->sequence) & 1) {
+        cpu_pause();
+    }
+
+    asm volatile ("" ::: "memory");
+    return sequence;
+}
+
+static inline bool read_seqretry(const Seqlock* lock, u32 sequence) {
+    asm volatile ("" ::: "memory");
+    return lock->sequence != sequence;
+}
@@ -0,0 +1,96 @@
+#include <util.h>
+#include <string.h>
+#include "drivers/serial.h"
+#include "tsc.h"
+#include "boot_profile.h"
+
+typedef struct {
+    String name;
+    u64    cycles;
+} BootPhase;
+
+static u64       start_tsc;
+static u64       last_tsc;
+static BootPhase phases[BOOT_PROFILE_MAX_PHASES];
+static u32       phase_count;
+static u32       dropped_phases;
+
+void boot_profile_start(void) {
+    start_tsc   = tsc_read();
+    last_tsc    = start_tsc;
+    phase_count = 0;
+}
+
+void boot_phase(String name) {
+    u64 now = tsc_read();
+
+    if (phase_count == BOOT_PROFILE_MAX_PHASES) {
+        dropped_phases++;
+    }
+    else {
+        phases[phase_count++] = (BootPhase) { name, now - last_tsc };
+    }
+
+    // Leave the time spent in here out of the next phase.
+    last_tsc = tsc_read();
+}
+
+static void print_microseconds(u64 ns) {
+    print_log_u64(ns / 1000);
+    print_log(strlit("."));
+    u64 fraction = (ns % 1000) / 10;
+    if (fraction < 10) {
+        print_log(strlit("0"));
+    }
+    print_log_u64(fraction);
+}
+
+void boot_profile_report(void) {
+    // Insertion sort by duration, slowest first. There are only a few dozen
+    // phases and the original order is still in `phases`.
+    BootPhase sorted[BOOT_PROFILE_MAX_PHASES];
+    u64 total_cycles = 0;
+
+    for (u32 i = 0; i < phase_count; i++) {
+        BootPhase phase = phases[i];
+        u32 j = i;
+        while (j > 0 && sorted[j-1].cycles < phase.cycles) {
+            sorted[j] = sorted[j-1];
+            j--;
+        }
+        sorted[j] = phase;
+        total_cycles += phase.cycles;
+    }
+
+    if (tsc_frequency() == 0) {
+        print_log(strlit("boot: TSC not calibrated, no profile\n"));
+        return;
+    }
+
+    print_log(strlit("boot: "));
+    print_log_u64(phase_count);
+    print_log(strlit(" phases, "));
+    print_microseconds(tsc_to_ns(total_cycles));
+    print_log(strlit(" us total\n"));
+
+    for (u32 i = 0; i < phase_count; i++) {
+        u64 ns        = tsc_to_ns(sorted[i].cycles);
+        u64 per_mille = total_cycles ? sorted[i].cycles * 1000 / total_cycles : 0;
+
+        print_log(strlit("boot:   "));
+        print_microseconds(ns);
+        print_log(strlit(" us "));
+        print_log_u64(per_mille / 10);
+        print_log(strlit("."));
+        print_log_u64(per_mille % 10);
+        print_log(strlit("% "));
+        print_log(sorted[i].name);
+        print_log(strlit("\n"));
+    }
+
+    if (dropped_phases != 0) {
+        print_log(strlit("boot: "));
+        print_log_u64(dropped_phases);
+        print_log(strlit(" phases dropped, raise BOOT_PROFILE_MAX_PHASES\n"));
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Boot phase profiler. boot_profile_start() is the first thing main() does,
+// after that every boot_phase() call closes the phase that started at the
+// previous mark. Marks only store a raw TSC value, so they cost the same
+// before and after tsc_init(); boot_profile_report() converts them to time
+// and prints the phases slowest first.
+
+#define BOOT_PROFILE_MAX_PHASES 64
+
+void boot_profile_start(void);
+void boot_phase(String name);
+void boot_profile_report(void);
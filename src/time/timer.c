@@ -0,0 +1,327 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/idt.h"
+#include "cpu/spinlock.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "drivers/serial.h"
+#include "drivers/lapic.h"
+#include "mm/pmm.h"
+#include "mem.h"
+#include "panic.h"
+#include "tsc.h"
+#include "timer.h"
+
+#define TIMER_SLOT_COUNT  (TIMER_LEVELS * TIMER_SLOTS)
+#define TIMER_SLOT_MASK   (TIMER_SLOTS - 1)
+#define TIMER_WHEEL_BITS  (TIMER_LEVELS * TIMER_SLOT_BITS)
+#define TIMER_NONE        0xFFFFFFFFFFFFFFFFull
+
+// Timer.slot values past the wheel proper.
+#define TIMER_SLOT_OVERFLOW TIMER_SLOT_COUNT
+#define TIMER_SLOT_EXPIRED  (TIMER_SLOT_COUNT + 1)
+
+typedef struct TimerWheel {
+    Spinlock lock;
+    u64      now;                  // Tick everything before has been handled
+    u64      programmed;           // Tick the hardware fires at, TIMER_NONE if off
+    u64      occupied[TIMER_LEVELS];
+    Timer*   slots[TIMER_SLOT_COUNT];
+    Timer*   overflow;             // Further out than the top level reaches
+    Timer*   expired;              // Due, callback not yet run
+    u64      fired;
+    u64      interrupts;
+    u64      programs;
+} TimerWheel;
+
+_Static_assert(sizeof(TimerWheel) <= PAGE_SIZE, "timer_init_cpu() hands out one page");
+
+static u64 ticks_to_tsc(u64 ticks) {
+    return ticks > (TIMER_NONE >> TIMER_TICK_SHIFT) ? TIMER_NONE : ticks << TIMER_TICK_SHIFT;
+}
+
+static u32 digit(u64 tick, u32 level) {
+    return (tick >> (level * TIMER_SLOT_BITS)) & TIMER_SLOT_MASK;
+}
+
+// The tick at which `slot` of `level` comes round next: the wheel's current
+// tick with that level's digit replaced and everything below cleared.
+static u64 slot_tick(u64 now, u32 level, u32 slot) {
+    u32 shift = level * TIMER_SLOT_BITS;
+    u64 above = now & ~((1ull << (shift + TIMER_SLOT_BITS)) - 1);
+    return above | ((u64)slot << shift);
+}
+
+static u64 overflow_tick(u64 now) {
+    return ((now >> TIMER_WHEEL_BITS) + 1) << TIMER_WHEEL_BITS;
+}
+
+static void list_push(Timer** head, Timer* timer) {
+    timer->next = *head;
+    if (timer->next != NULL) {
+        timer->next->link = &timer->next;
+    }
+
+    timer->link = head;
+    *head = timer;
+}
+
+static void unlink(TimerWheel* wheel, Timer* timer) {
+    *timer->link = timer->next;
+    if (timer->next != NULL) {
+        timer->next->link = timer->link;
+    }
+
+    if (timer->slot < TIMER_SLOT_COUNT && wheel->slots[timer->slot] == NULL) {
+        wheel->occupied[timer->slot / TIMER_SLOTS] &= ~(1ull << (timer->slot % TIMER_SLOTS));
+    }
+
+    timer->link = NULL;
+    __atomic_store_n(&timer->wheel, NULL, __ATOMIC_RELEASE);
+}
+
+// Files the timer by the highest digit in which its expiry differs from
+// the wheel's tick. Anything already due goes into the current level 0
+// slot, which the caller is about to look at or has the hardware fire for.
+// Returns the tick this placement needs attention at.
+static u64 place(TimerWheel* wheel, Timer* timer) {
+    u64 expires = timer->expires < wheel->now ? wheel->now : timer->expires;
+    u64 diff    = expires ^ wheel->now;
+    u32 level   = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / TIMER_SLOT_BITS;
+
+    __atomic_store_n(&timer->wheel, wheel, __ATOMIC_RELEASE);
+    if (level >= TIMER_LEVELS) {
+        timer->slot = TIMER_SLOT_OVERFLOW;
+        list_push(&wheel->overflow, timer);
+        return overflow_tick(wheel->now);
+    }
+
+    u32 slot = digit(expires, level);
+    timer->slot = level * TIMER_SLOTS + slot;
+    list_push(&wheel->slots[timer->slot], timer);
+    wheel->occupied[level] |= 1ull << slot;
+    return slot_tick(wheel->now, level, slot);
+}
+
+// Earliest tick anything on the wheel needs attention, and which level
+// (TIMER_LEVELS for the overflow list) it is for. Every occupied slot lies
+// ahead of the wheel's digit at its level, so the lowest set bit of each
+// level is that level's next event.
+static u64 next_event(TimerWheel* wheel, u32* source) {
+    u64 next = TIMER_NONE;
+    if (wheel->overflow != NULL) {
+        next    = overflow_tick(wheel->now);
+        *source = TIMER_LEVELS;
+    }
+
+    for (u32 level = 0; level < TIMER_LEVELS; level++) {
+        if (wheel->occupied[level] == 0) {
+            continue;
+        }
+
+        u64 tick = slot_tick(wheel->now, level, __builtin_ctzll(wheel->occupied[level]));
+        if (tick < next) {
+            next    = tick;
+            *source = level;
+        }
+    }
+
+    return next;
+}
+
+static void program(TimerWheel* wheel, u64 tick) {
+    wheel->programmed = tick;
+    wheel->programs++;
+
+    if (tick == TIMER_NONE) {
+        lapic_timer_stop();
+    }
+    else {
+        lapic_timer_oneshot(VECTOR_LAPIC_TIMER, ticks_to_tsc(tick));
+    }
+}
+
+// Walks the wheel forward to `target`, jumping straight from one event to
+// the next. Due timers move to the expired list, cascaded ones are filed
+// again relative to the new tick. Nothing can be filed below the level
+// whose event comes first, so jumping never skips over a slot.
+static void advance(TimerWheel* wheel, u64 target) {
+    for (;;) {
+        u32 source = 0;
+        u64 next   = next_event(wheel, &source);
+        if (next > target) {
+            if (target > wheel->now) {
+                wheel->now = target;
+            }
+            return;
+        }
+
+        wheel->now = next;
+
+        Timer* list;
+        if (source == TIMER_LEVELS) {
+            list = wheel->overflow;
+            wheel->overflow = NULL;
+        }
+        else {
+            u32 slot = source * TIMER_SLOTS + digit(next, source);
+            list = wheel->slots[slot];
+            wheel->slots[slot] = NULL;
+            wheel->occupied[source] &= ~(1ull << digit(next, source));
+        }
+
+        while (list != NULL) {
+            Timer* timer = list;
+            list = timer->next;
+
+            if (timer->expires <= wheel->now) {
+                timer->slot = TIMER_SLOT_EXPIRED;
+                list_push(&wheel->expired, timer);
+            }
+            else {
+                place(wheel, timer);
+            }
+        }
+    }
+}
+
+// Picks the interrupt mode and sets up the BSP's wheel. APs get theirs
+// from the BSP through timer_init_cpu() before they start.
+void timer_init(void) {
+    if (tsc_frequency() == 0) {
+        panic(strlit("timer: the TSC frequency is unknown"));
+    }
+
+    bool deadline = lapic_timer_has_deadline();
+    if (!deadline) {
+        lapic_timer_calibrate();
+    }
+
+    print_log(strlit("timer: tickless, "));
+    print_log(deadline ? strlit("TSC-deadline mode\n") : strlit("LAPIC one-shot mode\n"));
+    timer_init_cpu(this_cpu());
+}
+
+void timer_init_cpu(PerCpu* cpu) {
+    u64 phys = pmm_alloc_page();
+    if (phys == 0) {
+        panic(strlit("timer: out of memory for a timer wheel"));
+    }
+
+    TimerWheel* wheel = phys_to_virt(phys);
+    memset(wheel, 0, sizeof(TimerWheel));
+    wheel->now        = tsc_read() >> TIMER_TICK_SHIFT;
+    wheel->programmed = TIMER_NONE;
+    cpu->timer_wheel  = wheel;
+}
+
+void timer_setup(Timer* timer, TimerCallback callback, void* argument) {
+    memset(timer, 0, sizeof(Timer));
+    timer->callback = callback;
+    timer->argument = argument;
+}
+
+// (Re)arms the timer on the calling CPU's wheel for an absolute TSC
+// deadline. The hardware is only touched if this is now the earliest event.
+void timer_arm(Timer* timer, u64 deadline) {
+    timer_cancel(timer);
+
+    TimerWheel* wheel = this_cpu()->timer_wheel;
+    u64 flags = spin_lock_irqsave(&wheel->lock);
+
+    timer->deadline = deadline;
+    timer->expires  = (deadline >> TIMER_TICK_SHIFT) + ((deadline & ((1ull << TIMER_TICK_SHIFT) - 1)) != 0);
+
+    u64 tick = place(wheel, timer);
+    if (tick < wheel->programmed) {
+        program(wheel, tick);
+    }
+
+    spin_unlock_irqrestore(&wheel->lock, flags);
+}
+
+void timer_arm_ns(Timer* timer, u64 ns) {
+    timer_arm(timer, tsc_read() + tsc_from_ns(ns));
+}
+
+// Returns whether the timer was pending, false means its callback has run,
+// is running or it was never armed. A cancelled timer may still cost its
+// CPU one spurious interrupt, the hardware is left as it is.
+bool timer_cancel(Timer* timer) {
+    for (;;) {
+        TimerWheel* wheel = __atomic_load_n(&timer->wheel, __ATOMIC_ACQUIRE);
+        if (wheel == NULL) {
+            return false;
+        }
+
+        u64 flags = spin_lock_irqsave(&wheel->lock);
+        bool pending = timer->wheel == wheel;
+        if (pending) {
+            unlink(wheel, timer);
+        }
+        spin_unlock_irqrestore(&wheel->lock, flags);
+
+        // Otherwise it fired or moved to another wheel while we took the lock.
+        if (pending) {
+            return true;
+        }
+    }
+}
+
+bool timer_pending(Timer* timer) {
+    return __atomic_load_n(&timer->wheel, __ATOMIC_ACQUIRE) != NULL;
+}
+
+// Called from the LAPIC timer interrupt. The hardware is set for the next
+// event before any callback runs, then the due timers are taken off one at
+// a time so each can still be cancelled until its callback starts.
+void timer_expire(void) {
+    TimerWheel* wheel = this_cpu()->timer_wheel;
+    if (wheel == NULL) {
+        return;
+    }
+
+    spin_lock(&wheel->lock);
+    wheel->interrupts++;
+    advance(wheel, tsc_read() >> TIMER_TICK_SHIFT);
+    u32 source;
+    program(wheel, next_event(wheel, &source));
+    spin_unlock(&wheel->lock);
+
+    for (;;) {
+        spin_lock(&wheel->lock);
+        Timer* timer = wheel->expired;
+        if (timer != NULL) {
+            unlink(wheel, timer);
+            wheel->fired++;
+        }
+        spin_unlock(&wheel->lock);
+
+        if (timer == NULL) {
+            return;
+        }
+
+        timer->callback(timer);
+    }
+}
+
+void timer_print_stats(void) {
+    for (u32 i = 0; i < percpu_count(); i++) {
+        TimerWheel* wheel = percpu_get(i)->timer_wheel;
+        if (wheel == NULL) {
+            continue;
+        }
+
+        print_log(strlit("timer: cpu "));
+        print_log_u64(i);
+        print_log(strlit(" interrupts="));
+        print_log_u64(wheel->interrupts);
+        print_log(strlit(" fired="));
+        print_log_u64(wheel->fired);
+        print_log(strlit(" programs="));
+        print_log_u64(wheel->programs);
+        print_log(strlit("\n"));
+    }
+}
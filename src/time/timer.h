@@ -0,0 +1,50 @@
+#pragma once
+
+// One-shot timers on a per-CPU hierarchical timing wheel, keyed by TSC
+// deadline. Arming and cancelling are O(1). There is no periodic tick: the
+// LAPIC timer (TSC-deadline mode where the CPU has it, one-shot otherwise)
+// is only programmed for the next point the wheel needs attention, so a CPU
+// with nothing pending sleeps until some other interrupt arrives.
+//
+// The wheel counts in ticks of 2^TIMER_TICK_SHIFT TSC cycles. Level l has
+// TIMER_SLOTS slots of 64^l ticks each and a timer sits in the level of the
+// highest base-64 digit where its expiry still differs from the wheel's
+// current tick. Reaching a slot above level 0 cascades its timers down, a
+// level 0 slot holds timers that all expire on the same tick. Expiries
+// beyond the top level wait on an overflow list.
+//
+// Callbacks run from the timer interrupt with interrupts off and no lock
+// held, on the CPU that armed the timer. They may arm or cancel timers,
+// including their own.
+
+#define TIMER_LEVELS     7
+#define TIMER_SLOT_BITS  6
+#define TIMER_SLOTS      (1 << TIMER_SLOT_BITS)
+#define TIMER_TICK_SHIFT 10
+
+struct Timer;
+struct TimerWheel;
+struct PerCpu;
+
+typedef void (*TimerCallback)(struct Timer* timer);
+
+typedef struct Timer {
+    struct Timer*      next;
+    struct Timer**     link;     // Whatever points here, NULL when not pending
+    struct TimerWheel* wheel;
+    u64                deadline; // TSC
+    u64                expires;  // Wheel tick, the deadline rounded up
+    u32                slot;     // level * TIMER_SLOTS + slot, or one of the lists
+    TimerCallback      callback;
+    void*              argument;
+} Timer;
+
+void timer_init(void);
+void timer_init_cpu(struct PerCpu* cpu);
+void timer_setup(Timer* timer, TimerCallback callback, void* argument);
+void timer_arm(Timer* timer, u64 deadline);
+void timer_arm_ns(Timer* timer, u64 ns);
+bool timer_cancel(Timer* timer);
+bool timer_pending(Timer* timer);
+void timer_expire(void);
+void timer_print_stats(void);
@@ -0,0 +1,144 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "sync/seqlock.h"
+#include "tsc.h"
+
+#define PIT_FREQUENCY     1193182
+#define PIT_CHANNEL2_DATA 0x42
+#define PIT_COMMAND       0x43
+#define PIT_GATE_PORT     0x61 // Bit 0 gates channel 2, bit 5 reads its output
+
+#define PIT_GATE_ENABLE   (1 << 0)
+#define PIT_SPEAKER       (1 << 1)
+#define PIT_CHANNEL2_OUT  (1 << 5)
+
+// Calibration results, written under `calibration` and read on every
+// conversion, on any CPU, without a lock.
+static Seqlock calibration;
+static u64     frequency;
+static u64     ns_multiplier;    // Nanoseconds per cycle as 32.32 fixed point
+static u64     cycle_multiplier; // Cycles per nanosecond as 32.32 fixed point
+static bool    has_rdtscp;
+static bool    invariant;
+
+// Runs PIT channel 2 as a one-shot for `ms` milliseconds and returns how
+// many TSC cycles passed, or 0 if the PIT output never went high.
+static u64 measure_pit_interval(u32 ms) {
+    u16 count = (u16)((u64)PIT_FREQUENCY * ms / 1000);
+
+    // Gate off with the speaker disconnected, then mode 0 (interrupt on
+    // terminal count), binary, low then high byte.
+    u8 gate = inb(PIT_GATE_PORT) & ~(PIT_GATE_ENABLE | PIT_SPEAKER);
+    outb(PIT_GATE_PORT, gate);
+    outb(PIT_COMMAND, 0xB0);
+    outb(PIT_CHANNEL2_DATA, count & 0xFF);
+    outb(PIT_CHANNEL2_DATA, count >> 8);
+
+    // Counting starts on the rising edge of the gate.
+    outb(PIT_GATE_PORT, gate | PIT_GATE_ENABLE);
+    u64 start = tsc_read();
+
+    u64 spins = 0;
+    while (!(inb(PIT_GATE_PORT) & PIT_CHANNEL2_OUT)) {
+        if (++spins > 100000000) {
+            return 0;
+        }
+    }
+
+    u64 end = tsc_read();
+    outb(PIT_GATE_PORT, gate);
+    return end - start;
+}
+
+// Takes the shortest of a few rounds: a round can only come out too long
+// (an SMI or a slow port read at either end), never too short.
+bool tsc_init(void) {
+    has_rdtscp = false;
+    invariant  = false;
+    if (cpuid(0x80000000, 0).eax >= 0x80000001) {
+        has_rdtscp = (cpuid(0x80000001, 0).edx & CPUID_EXT_EDX_RDTSCP) != 0;
+    }
+
+    if (cpuid(0x80000000, 0).eax >= 0x80000007) {
+        invariant = (cpuid(0x80000007, 0).edx & CPUID_APM_EDX_INVARIANT_TSC) != 0;
+    }
+
+    u64 best = 0;
+    for (u32 i = 0; i < TSC_CALIBRATION_ROUNDS; i++) {
+        u64 cycles = measure_pit_interval(TSC_CALIBRATION_MS);
+        if (cycles != 0 && (best == 0 || cycles < best)) {
+            best = cycles;
+        }
+    }
+
+    if (best == 0) {
+        print_log(strlit("tsc: PIT calibration failed\n"));
+        return false;
+    }
+
+    u64 measured = best * 1000 / TSC_CALIBRATION_MS;
+    u64 flags    = write_seqlock(&calibration);
+    frequency     = measured;
+    ns_multiplier = ((u64)1000000000 << 32) / measured;
+    // In two parts, frequency << 32 would overflow.
+    cycle_multiplier = (measured / 1000000000 << 32) + ((measured % 1000000000) << 32) / 1000000000;
+    write_sequnlock(&calibration, flags);
+
+    print_log(strlit("tsc: "));
+    print_log_u64(frequency / 1000000);
+    print_log(strlit(" MHz rdtscp="));
+    print_log_u64(has_rdtscp);
+    print_log(strlit(" invariant="));
+    print_log_u64(invariant);
+    print_log(strlit("\n"));
+    return true;
+}
+
+// Ordered against earlier instructions, with rdtscp where the CPU has it.
+u64 tsc_read(void) {
+    if (has_rdtscp) {
+        return rdtscp(NULL);
+    }
+
+    return rdtsc_ordered();
+}
+
+u64 tsc_frequency(void) {
+    return frequency;
+}
+
+bool tsc_invariant(void) {
+    return invariant;
+}
+
+// The 128-bit product keeps this exact for any realistic uptime, and a
+// multiply by a u64 doesn't need a runtime library call the way a 128-bit
+// division would.
+u64 tsc_to_ns(u64 cycles) {
+    u32 sequence;
+    u64 multiplier;
+    do {
+        sequence   = read_seqbegin(&calibration);
+        multiplier = ns_multiplier;
+    } while (read_seqretry(&calibration, sequence));
+
+    return (u64)(((unsigned __int128)cycles * multiplier) >> 32);
+}
+
+u64 tsc_from_ns(u64 ns) {
+    u32 sequence;
+    u64 multiplier;
+    do {
+        sequence   = read_seqbegin(&calibration);
+        multiplier = cycle_multiplier;
+    } while (read_seqretry(&calibration, sequence));
+
+    return (u64)(((unsigned __int128)ns * multiplier) >> 32);
+}
+
+u64 tsc_ns(void) {
+    return tsc_to_ns(tsc_read());
+}
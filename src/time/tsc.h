@@ -0,0 +1,16 @@
+#pragma once
+
+// Time stamp counter as the kernel clock. tsc_init() measures its frequency
+// against the PIT; tsc_read() works before that, but cycle counts only turn
+// into nanoseconds once it has run.
+
+#define TSC_CALIBRATION_MS     10
+#define TSC_CALIBRATION_ROUNDS 3
+
+bool tsc_init(void);
+u64  tsc_read(void);
+u64  tsc_frequency(void);
+bool tsc_invariant(void);
+u64  tsc_to_ns(u64 cycles);
+u64  tsc_from_ns(u64 ns);
+u64  tsc_ns(void);
@@ -0,0 +1,189 @@
+#include <util.h>
+#include <string.h>
+#include "cpu/cpu.h"
+#include "cpu/gdt.h"
+#include "cpu/spinlock.h"
+#include "drivers/serial.h"
+#include "sched/run_queue.h"
+#include "cpu/percpu.h"
+#include "mm/pmm.h"
+#include "mm/vmm.h"
+#include "time/tsc.h"
+#include "mem.h"
+#include "trace.h"
+
+typedef struct {
+    String name;
+    String args[TRACE_MAX_ARGS];
+} TraceEventInfo;
+
+static const TraceEventInfo event_info[TRACE_EVENT_COUNT] = {
+#define TRACE_EVENT(id, name, arg0, arg1, arg2) { strlit(name), { strlit(arg0), strlit(arg1), strlit(arg2) } },
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+bool trace_enabled;
+
+// Claims a slot with xadd but without a lock prefix. Only the owning CPU
+// writes the head, with interrupts off, and a single instruction can't be
+// split by an NMI, so one tracing in the middle of a record still gets a
+// slot of its own without a locked bus cycle.
+static inline u64 claim_slot(u64* head) {
+    u64 index = 1;
+    asm volatile ("xadd [%1], %0" : "+r" (index) : "r" (head) : "memory");
+    return index;
+}
+
+void trace_init(void) {
+    trace_init_cpu(this_cpu());
+    trace_enabled = true;
+}
+
+// Called by the bootstrap processor for each AP before it starts, so the
+// APs never map memory (and shoot down TLBs) with interrupts off.
+void trace_init_cpu(PerCpu* cpu) {
+    u64 pages = (sizeof(TraceRing) + PAGE_SIZE - 1) / PAGE_SIZE;
+    TraceRing* ring = vmm_alloc(pages, VMM_FLAG_WRITE);
+    if (ring == NULL) {
+        print_log(strlit("trace: out of memory, no ring for cpu "));
+        print_log_u64(cpu->cpu_id);
+        print_log(strlit("\n"));
+        return;
+    }
+
+    memset(ring, 0, sizeof(TraceRing));
+    cpu->trace_ring = ring;
+}
+
+// The record is invalidated first and its sequence stored last, so a dump
+// running on another CPU can tell a finished record from one that is being
+// written or was overwritten while it read it. Interrupts stay off until
+// the record is complete, TRACE is also used from preemptible code and the
+// thread must not move to another CPU between this_cpu() and the last store.
+void trace_record(u32 event, u64 arg0, u64 arg1, u64 arg2) {
+    u64        flags = interrupts_save();
+    PerCpu*    cpu   = this_cpu();
+    TraceRing* ring  = cpu->trace_ring;
+    if (ring == NULL) {
+        interrupts_restore(flags);
+        return;
+    }
+
+    u64 index = claim_slot(&ring->head);
+    TraceRecord* record = &ring->records[index & (TRACE_RING_RECORDS - 1)];
+
+    __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+    asm volatile ("" ::: "memory");
+    record->tsc     = rdtsc();
+    record->event   = event;
+    record->cpu     = cpu->cpu_id;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    __atomic_store_n(&record->sequence, index + 1, __ATOMIC_RELEASE);
+    interrupts_restore(flags);
+}
+
+static u8* put(u8* out, const void* data, u64 size) {
+    memcpy(out, data, size);
+    return out + size;
+}
+
+static u8* put_string(u8* out, String string) {
+    u8 length = string.len > 255 ? 255 : (u8)string.len;
+    *out++ = length;
+    return put(out, string.string, length);
+}
+
+// Copies one ring oldest first, skipping records that are half written or
+// got overwritten during the copy. Returns the number kept.
+static u32 copy_ring(TraceRing* ring, TraceRecord* out) {
+    u64 head  = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    u64 start = head > TRACE_RING_RECORDS ? head - TRACE_RING_RECORDS : 0;
+    u32 kept  = 0;
+
+    for (u64 index = start; index < head; index++) {
+        TraceRecord* record = &ring->records[index & (TRACE_RING_RECORDS - 1)];
+        u64 before = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+        out[kept] = *record;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        u64 after = __atomic_load_n(&record->sequence, __ATOMIC_RELAXED);
+
+        if (before == index + 1 && after == before) {
+            kept++;
+        }
+    }
+
+    return kept;
+}
+
+// Layout, little endian:
+//
+//     TRACE_DUMP_MAGIC
+//     u64 tsc_frequency, u32 event_count
+//     per event: u8 length + name, then three u8 length + argument name
+//     u32 cpu_count
+//     per cpu: u32 cpu_id, u32 record_count, TraceRecord[record_count]
+//     TRACE_DUMP_END_MAGIC
+//
+// The whole dump is built in memory first and written with one
+// serial_write(), so nothing else can end up in the middle of it.
+void trace_dump(void) {
+    u64 size = 8 + 12 + 4 + 8;
+    for (u32 i = 0; i < TRACE_EVENT_COUNT; i++) {
+        size += 4 * 256;
+    }
+
+    size += percpu_count() * (8 + sizeof(TraceRing));
+
+    u64 pages  = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    u8* buffer = vmm_alloc(pages, VMM_FLAG_WRITE);
+    if (buffer == NULL) {
+        print_log(strlit("trace: out of memory for the dump\n"));
+        return;
+    }
+
+    u8* out = put(buffer, TRACE_DUMP_MAGIC, 8);
+    u64 frequency   = tsc_frequency();
+    u32 event_count = TRACE_EVENT_COUNT;
+    out = put(out, &frequency, 8);
+    out = put(out, &event_count, 4);
+
+    for (u32 i = 0; i < TRACE_EVENT_COUNT; i++) {
+        out = put_string(out, event_info[i].name);
+        for (u32 arg = 0; arg < TRACE_MAX_ARGS; arg++) {
+            out = put_string(out, event_info[i].args[arg]);
+        }
+    }
+
+    u32 cpu_count = percpu_count();
+    out = put(out, &cpu_count, 4);
+
+    u64 total = 0;
+    for (u32 i = 0; i < cpu_count; i++) {
+        PerCpu* cpu = percpu_get(i);
+        u32 count = 0;
+
+        out = put(out, &cpu->cpu_id, 4);
+        u8* count_slot = out;
+        out += 4;
+        if (cpu->trace_ring != NULL) {
+            count = copy_ring(cpu->trace_ring, (TraceRecord*)out);
+        }
+
+        memcpy(count_slot, &count, 4);
+        out   += (u64)count * sizeof(TraceRecord);
+        total += count;
+    }
+
+    out = put(out, TRACE_DUMP_END_MAGIC, 8);
+
+    print_log(strlit("trace: dumping "));
+    print_log_u64(total);
+    print_log(strlit(" records\n"));
+    serial_write(buffer, out - buffer);
+    print_log(strlit("\n"));
+
+    vmm_free(buffer, pages);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Tracepoints. TRACE(ID, args...) stores a TSC timestamp, the event id and
+// up to three u64 arguments in the calling CPU's ring. Writers never lock:
+// interrupts are off from picking the ring to the finished record, so a
+// preempted thread can't go on to write into the ring of a CPU it has left,
+// and the slot is claimed with one non-locked xadd, which an NMI tracing
+// on the same CPU can't tear. When the ring wraps the oldest records are
+// overwritten.
+//
+// trace_dump() sends every ring over serial as one binary blob framed by
+// TRACE_DUMP_MAGIC and TRACE_DUMP_END_MAGIC. tools/trace_decode.c turns a
+// serial capture into Chrome trace JSON (chrome://tracing, Perfetto).
+
+struct PerCpu;
+
+#define TRACE_RING_RECORDS   2048 // Per CPU, a power of two
+#define TRACE_MAX_ARGS       3
+#define TRACE_DUMP_MAGIC     "@@TRACE1"
+#define TRACE_DUMP_END_MAGIC "@@TREND1"
+
+typedef enum {
+#define TRACE_EVENT(id, name, arg0, arg1, arg2) TRACE_EVENT_##id,
+#include "trace_events.h"
+#undef TRACE_EVENT
+    TRACE_EVENT_COUNT
+} TraceEventId;
+
+typedef struct {
+    u64 sequence; // Index + 1 once the record is complete, 0 while written
+    u64 tsc;
+    u32 event;
+    u32 cpu;
+    u64 args[TRACE_MAX_ARGS];
+} TraceRecord;
+
+typedef struct TraceRing {
+    u64         head; // Next slot, only the owning CPU moves it, interrupts off
+    TraceRecord records[TRACE_RING_RECORDS];
+} TraceRing;
+
+extern bool trace_enabled;
+
+#define TRACE(id, ...) TRACE_ARGS_(id, ##__VA_ARGS__, 0, 0, 0)
+#define TRACE_ARGS_(id, a0, a1, a2, ...) do { \
+    if (__builtin_expect(trace_enabled, 1)) { \
+        trace_record(TRACE_EVENT_##id, (u64)(a0), (u64)(a1), (u64)(a2)); \
+    } \
+} while (0)
+
+void trace_init(void);
+void trace_init_cpu(struct PerCpu* cpu);
+void trace_record(u32 event, u64 arg0, u64 arg1, u64 arg2);
+void trace_dump(void);
@@ -0,0 +1,16 @@
+// Every tracepoint in the kernel. Each line is
+//
+//     TRACE_EVENT(ID, "name", "arg0", "arg1", "arg2")
+//
+// and becomes TRACE_EVENT_ID. Unused arguments are "". The names travel
+// with every dump, so the host decoder doesn't need a copy of this list.
+// Append new events at the end, ids are positional.
+//
+// No #pragma once, this file is included once per expansion.
+
+TRACE_EVENT(IRQ,           "irq",           "vector",  "rip",    "")
+TRACE_EVENT(SCHED_SWITCH,  "sched_switch",  "prev",    "next",   "preempt")
+TRACE_EVENT(SCHED_STEAL,   "sched_steal",   "thread",  "victim", "")
+TRACE_EVENT(THREAD_CREATE, "thread_create", "thread",  "cpu",    "")
+TRACE_EVENT(THREAD_EXIT,   "thread_exit",   "thread",  "",       "")
+TRACE_EVENT(TLB_SHOOTDOWN, "tlb_shootdown", "targets", "",       "")
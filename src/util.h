@@ -19,3 +19,8 @@ typedef double f64;
 
 #define local_persist static;
 #define global_variable static;
+#define ArrayCount(x) (sizeof(x)/sizeof((x)[0]))
+
+#define KB(x) ((u64)(x)*1024)
+#define MB(x) ((u64)(x)*1024*1024)
+#define GB(x) ((u64)(x)*1024*1024*1024)
@@ -0,0 +1,136 @@
+// Compares two sets of in-kernel benchmark results, as printed by
+// bench_report() (src/bench/bench.h):
+//
+//     [bench] <name>[.<size>] <value> <unit>
+//
+//     bench_compare <baseline> <results> [tolerance_percent]
+//
+// Lines that aren't bench results are ignored, so a raw serial capture
+// works as either file. A result counts as a regression when it is worse
+// than the baseline by more than the tolerance (10% by default). Units
+// starting with cycles, the times ns, us and ms, and costs per operation
+// ending in /op or /Mop (retries/Mop) are lower-is-better, everything else
+// (bytes/cycle, ops/s, MB/s) higher-is-better. Exits with 1 if anything
+// regressed or a baseline result is missing.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_RESULTS 1024
+#define MAX_NAME    128
+
+typedef struct {
+    char   name[MAX_NAME];
+    char   unit[MAX_NAME];
+    double value;
+    int    seen;
+} Result;
+
+typedef struct {
+    Result results[MAX_RESULTS];
+    int    count;
+} ResultSet;
+
+static int load(const char* path, ResultSet* set) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL && set->count < MAX_RESULTS) {
+        const char* start = strstr(line, "[bench] ");
+        Result* result = &set->results[set->count];
+        if (start != NULL && sscanf(start, "[bench] %127s %lf %127s", result->name, &result->value, result->unit) == 3) {
+            set->count++;
+        }
+    }
+
+    fclose(file);
+    return 1;
+}
+
+static Result* find(ResultSet* set, const char* name) {
+    for (int i = 0; i < set->count; i++) {
+        if (strcmp(set->results[i].name, name) == 0) {
+            return &set->results[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int ends_with(const char* string, const char* suffix) {
+    size_t length = strlen(string), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(string + length - suffix_length, suffix) == 0;
+}
+
+static int lower_is_better(const char* unit) {
+    return strncmp(unit, "cycles", 6) == 0 || strcmp(unit, "ns") == 0 ||
+           strcmp(unit, "us") == 0 || strcmp(unit, "ms") == 0 ||
+           ends_with(unit, "/op") || ends_with(unit, "/Mop");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "usage: %s <baseline> <results> [tolerance_percent]\n", argv[0]);
+        return 2;
+    }
+
+    double tolerance = argc == 4 ? atof(argv[3]) : 10.0;
+
+    static ResultSet baseline, current;
+    if (!load(argv[1], &baseline)) {
+        fprintf(stderr, "bench_compare: can't read %s\n", argv[1]);
+        return 2;
+    }
+    if (!load(argv[2], &current)) {
+        fprintf(stderr, "bench_compare: can't read %s\n", argv[2]);
+        return 2;
+    }
+
+    int regressions = 0, missing = 0;
+    printf("%-40s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+
+    for (int i = 0; i < current.count; i++) {
+        Result* now    = &current.results[i];
+        Result* before = find(&baseline, now->name);
+        if (before == NULL) {
+            printf("%-40s %14s %14.2f %9s  new (%s)\n", now->name, "-", now->value, "-", now->unit);
+            continue;
+        }
+
+        before->seen = 1;
+
+        // Positive change is always an improvement.
+        double change = 0.0;
+        if (before->value != 0.0) {
+            change = (now->value - before->value) / before->value * 100.0;
+            if (lower_is_better(now->unit)) {
+                change = -change;
+            }
+        }
+
+        const char* verdict = "";
+        if (change < -tolerance) {
+            verdict = "  REGRESSION";
+            regressions++;
+        }
+        else if (change > tolerance) {
+            verdict = "  faster";
+        }
+
+        printf("%-40s %14.2f %14.2f %+8.1f%%%s\n", now->name, before->value, now->value, change, verdict);
+    }
+
+    for (int i = 0; i < baseline.count; i++) {
+        if (!baseline.results[i].seen) {
+            printf("%-40s %14.2f %14s %9s  MISSING\n", baseline.results[i].name, baseline.results[i].value, "-", "-");
+            missing++;
+        }
+    }
+
+    printf("\n%d results, %d regressed beyond %.1f%%, %d missing\n", current.count, regressions, tolerance, missing);
+    return regressions > 0 || missing > 0;
+}
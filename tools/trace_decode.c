@@ -0,0 +1,233 @@
+// Host side decoder for the kernel's trace dumps (src/trace/trace.h). Finds
+// the last dump in a serial capture and writes it as Chrome trace JSON,
+// which chrome://tracing and Perfetto open directly.
+//
+//     trace_decode <capture> [out.json]
+//
+// Without an output path the JSON goes to stdout.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DUMP_MAGIC     "@@TRACE1"
+#define DUMP_END_MAGIC "@@TREND1"
+#define MAX_ARGS       3
+
+typedef struct {
+    uint64_t sequence;
+    uint64_t tsc;
+    uint32_t event;
+    uint32_t cpu;
+    uint64_t args[MAX_ARGS];
+} Record;
+
+typedef struct {
+    char name[256];
+    char args[MAX_ARGS][256];
+} Event;
+
+typedef struct {
+    const uint8_t* data;
+    size_t         size;
+    size_t         offset;
+} Reader;
+
+static int read_bytes(Reader* reader, void* out, size_t size) {
+    if (reader->size - reader->offset < size) {
+        return 0;
+    }
+
+    memcpy(out, reader->data + reader->offset, size);
+    reader->offset += size;
+    return 1;
+}
+
+static int read_string(Reader* reader, char* out) {
+    uint8_t length;
+    if (!read_bytes(reader, &length, 1) || !read_bytes(reader, out, length)) {
+        return 0;
+    }
+
+    out[length] = '\0';
+    return 1;
+}
+
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 1 << 20;
+    size_t length   = 0;
+    uint8_t* data   = malloc(capacity);
+
+    size_t count;
+    while (data != NULL && (count = fread(data + length, 1, capacity - length, file)) > 0) {
+        length += count;
+        if (length == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+
+    fclose(file);
+    *size = length;
+    return data;
+}
+
+static const uint8_t* find_last(const uint8_t* data, size_t size, const char* magic) {
+    const uint8_t* found = NULL;
+    for (size_t i = 0; i + 8 <= size; i++) {
+        if (memcmp(data + i, magic, 8) == 0) {
+            found = data + i;
+        }
+    }
+
+    return found;
+}
+
+static void write_json_string(FILE* out, const char* string) {
+    fputc('"', out);
+    for (; *string; string++) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*string, out);
+    }
+    fputc('"', out);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <capture> [out.json]\n", argv[0]);
+        return 1;
+    }
+
+    size_t size;
+    uint8_t* data = read_file(argv[1], &size);
+    if (data == NULL) {
+        fprintf(stderr, "trace_decode: can't read %s\n", argv[1]);
+        return 1;
+    }
+
+    const uint8_t* start = find_last(data, size, DUMP_MAGIC);
+    if (start == NULL) {
+        fprintf(stderr, "trace_decode: no trace dump in %s\n", argv[1]);
+        return 1;
+    }
+
+    Reader reader = { start + 8, size - (size_t)(start + 8 - data), 0 };
+
+    uint64_t frequency;
+    uint32_t event_count;
+    if (!read_bytes(&reader, &frequency, 8) || !read_bytes(&reader, &event_count, 4) || frequency == 0) {
+        fprintf(stderr, "trace_decode: truncated header\n");
+        return 1;
+    }
+
+    Event* events = calloc(event_count, sizeof(Event));
+    for (uint32_t i = 0; i < event_count; i++) {
+        int ok = read_string(&reader, events[i].name);
+        for (uint32_t arg = 0; arg < MAX_ARGS && ok; arg++) {
+            ok = read_string(&reader, events[i].args[arg]);
+        }
+
+        if (!ok) {
+            fprintf(stderr, "trace_decode: truncated event table\n");
+            return 1;
+        }
+    }
+
+    uint32_t cpu_count;
+    if (!read_bytes(&reader, &cpu_count, 4)) {
+        fprintf(stderr, "trace_decode: truncated header\n");
+        return 1;
+    }
+
+    // Timestamps are made relative to the earliest record, which needs a
+    // first pass over every CPU's records.
+    size_t records_offset = reader.offset;
+    uint64_t base = UINT64_MAX;
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        uint32_t cpu, count;
+        if (!read_bytes(&reader, &cpu, 4) || !read_bytes(&reader, &count, 4)) {
+            fprintf(stderr, "trace_decode: truncated cpu header\n");
+            return 1;
+        }
+
+        for (uint32_t r = 0; r < count; r++) {
+            Record record;
+            if (!read_bytes(&reader, &record, sizeof(record))) {
+                fprintf(stderr, "trace_decode: truncated records on cpu %u\n", cpu);
+                return 1;
+            }
+
+            if (record.tsc < base) {
+                base = record.tsc;
+            }
+        }
+    }
+
+    char end[8];
+    if (!read_bytes(&reader, end, 8) || memcmp(end, DUMP_END_MAGIC, 8) != 0) {
+        fprintf(stderr, "trace_decode: missing end marker, the capture is probably cut off\n");
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc == 3 && (out = fopen(argv[2], "w")) == NULL) {
+        fprintf(stderr, "trace_decode: can't write %s\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(out, "{\"traceEvents\":[\n");
+
+    reader.offset = records_offset;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        uint32_t cpu, count;
+        read_bytes(&reader, &cpu, 4);
+        read_bytes(&reader, &count, 4);
+
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"cpu %u\"}}",
+                i == 0 ? "" : ",\n", cpu, cpu);
+
+        for (uint32_t r = 0; r < count; r++, total++) {
+            Record record;
+            read_bytes(&reader, &record, sizeof(record));
+
+            const char* name = record.event < event_count ? events[record.event].name : "unknown";
+            double us = (double)(record.tsc - base) * 1e6 / (double)frequency;
+
+            fprintf(out, ",\n{\"name\":");
+            write_json_string(out, name);
+            fprintf(out, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{", us, record.cpu);
+
+            int first = 1;
+            for (uint32_t arg = 0; arg < MAX_ARGS; arg++) {
+                const char* arg_name = record.event < event_count ? events[record.event].args[arg] : "";
+                if (arg_name[0] == '\0') {
+                    continue;
+                }
+
+                fprintf(out, "%s", first ? "" : ",");
+                write_json_string(out, arg_name);
+                fprintf(out, ":%llu", (unsigned long long)record.args[arg]);
+                first = 0;
+            }
+
+            fprintf(out, "}}");
+        }
+    }
+
+    fprintf(out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    fprintf(stderr, "trace_decode: %llu records from %u cpus\n", (unsigned long long)total, cpu_count);
+    return 0;
+}